@@ -24,9 +24,26 @@ bool CompareMatrices(const Matrix *a, const Matrix *b, size_t count);
 bool CompareColor(const Color &a, const Color &b);
 bool CompareTexture(const Texture &a, const Texture &b);
 
+// NOTE: Hashing raylib types, + 0.0f folds -0.0f into 0.0f so equal vectors hash equal
+template<>
+struct Hash<Vector2> {
+  uint64_t operator()(const Vector2& v) const {
+    float xy[2] = {v.x + 0.0f, v.y + 0.0f};
+    return hash_bytes(xy, sizeof(xy));
+  }
+};
+
+template<>
+struct Hash<Vector3> {
+  uint64_t operator()(const Vector3& v) const {
+    float xyz[3] = {v.x + 0.0f, v.y + 0.0f, v.z + 0.0f};
+    return hash_bytes(xyz, sizeof(xyz));
+  }
+};
+
 // NOTE: Commonly used types
-static constexpr uint32_t ArenaIndexSize = 100;
-using ArenaIndex = MapCT<const char*, void*, ArenaIndexSize>;
+static constexpr uint32_t ArenaIndexSize = 128;
+using ArenaIndex = ArenaIndexCT<ArenaIndexSize>;
 
 // NOTE: Common UI stuff
 struct UIScale {
@@ -43,6 +43,7 @@ void UpdateSettings(GameState& state) { //TODO: Where should I put this? Also ma
 
 
 void init(GameState& state) {
+  PROFILE_SCOPE("init");
   SetConfigFlags(FLAG_MSAA_4X_HINT);
   SetConfigFlags(FLAG_WINDOW_RESIZABLE);
   SetConfigFlags(FLAG_WINDOW_HIGHDPI);
@@ -56,10 +57,11 @@ void init(GameState& state) {
   SetTargetFPS(120);
 
   // FIX: find a better way to find out if we are hot code reloading
-  bool isReload = state.permanentArena.size() > 1700; // is our current load a hot code reload?
+  bool isReload = state.permanentArena.size() > sizeof(ArenaIndex); // is our current load a hot code reload?
 
   switch (state.gameMode) {
     case GameMode::MENU: {
+      ArenaTagScope tag(state.reloadArena, "menu resources");
       rresCentralDir& dir = state.reloadArena.create<rresCentralDir>();
       dir = rresLoadCentralDirectory("resources.rres");
       state.renderResources.dir = &dir;
@@ -210,6 +212,7 @@ void init(GameState& state) {
 }
 
 void render(GameState& state) {
+  PROFILE_SCOPE("render");
   switch (state.gameMode) {
     case GameMode::MENU: {
       BeginDrawing();
@@ -272,9 +275,16 @@ void render(GameState& state) {
 }
 
 void update(GameState& state) {
+  PROFILE_SCOPE("update");
   Cameras& cameras = *state.renderResources.cameras;
   Shaders& shaders = *state.renderResources.shaders;
 
+  if (IsKeyPressed(KEY_F9)) profiler_write_chrome(*state.profiler, "client_profile.json");
+  if (IsKeyPressed(KEY_F10)) {
+    const Arena* arenas[] = {&state.frameArena, &state.matchArena, &state.reloadArena, &state.permanentArena};
+    write_arena_stats("arena_stats.txt", arenas, 4);
+  }
+
   switch (state.gameMode) {
     case GameMode::MENU: {
       SetShaderValue(
@@ -327,12 +337,16 @@ void update(GameState& state) {
 }
 
 void reload(GameState& state) {
+  PROFILE_SCOPE("reload");
   state.renderResources.reload();
   state.reloadArena.clear();
   RCloseWindow();
 }
 
 EXPORT_FN void client_main(GameState& state) {
+  LogScope logging; // Joined before returning, so nothing keeps running once the library is unloaded
+  trace_attach(state.trace);
+  profiler_attach(state.profiler);
   init(state);
   uint64_t last_write_time = get_timestamp("./libclient.so");
   while (!WindowShouldClose()) {
@@ -340,9 +354,13 @@ EXPORT_FN void client_main(GameState& state) {
       break;
     state.frameCount++;
     state.deltaTime = GetFrameTime();
+    TRACE("frame %u dt %f", state.frameCount, state.deltaTime);
+    PROFILE_FRAME();
     update(state);
     render(state);
+    PROFILE_COUNTER("frame arena bytes", state.frameArena.used);
     state.frameArena.clear();
   }
+  if (WindowShouldClose()) profiler_write_chrome(*state.profiler, "client_profile.json"); // A reload keeps recording
   reload(state);
 }
@@ -247,17 +247,37 @@ struct GameState {
   Arena matchArena;        // Clears every match
   Arena reloadArena;       // Clears on hot-reload
   Arena permanentArena;    // Doesn't clear on hot-reload
+  Arena profilerArena;     // Profiler & its per thread rings, never clears
+
+  // Arena instrumentation, dump with write_arena_stats
+  ArenaStats frameArenaStats;
+  ArenaStats matchArenaStats;
+  ArenaStats reloadArenaStats;
+  ArenaStats permanentArenaStats;
+
+  TraceBuffer* trace = nullptr; // Opened by the host, the library attaches on every load
+  Profiler* profiler = nullptr; // Created with the state by the host, the library attaches on every load
 
   GameState()
     : frameArena(KB(5))
     , matchArena(MB(5))
     , reloadArena(MB(50))
     , permanentArena(MB(100))
+    , profilerArena(MB(128)) // Reserved only, a thread's ring commits when it first records
   {
-    frameArena.create_map_ct<const char*, void*, ArenaIndexSize>();
-    matchArena.create_map_ct<const char*, void*, ArenaIndexSize>();
-    reloadArena.create_map_ct<const char*, void*, ArenaIndexSize>();
-    permanentArena.create_map_ct<const char*, void*, ArenaIndexSize>();
+#if ARENA_STATS_ENABLED
+    frameArena.instrument(frameArenaStats, "frame");
+    matchArena.instrument(matchArenaStats, "match");
+    reloadArena.instrument(reloadArenaStats, "reload");
+    permanentArena.instrument(permanentArenaStats, "permanent");
+#endif
+
+    frameArena.create_arena_index_ct<ArenaIndexSize>();
+    matchArena.create_arena_index_ct<ArenaIndexSize>();
+    reloadArena.create_arena_index_ct<ArenaIndexSize>();
+    permanentArena.create_arena_index_ct<ArenaIndexSize>();
+
+    profiler = profiler_create(profilerArena);
   }
 };
 
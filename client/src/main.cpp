@@ -33,6 +33,7 @@ void unload_client(Client* client) {
 }
 
 int main() {
+    LogScope logging; // The host's own logger, libclient.so links its own copy of utils.cpp & runs one in client_main
     LOG_TRACE("Starting client...");
     
     Client client = load_client();
@@ -42,7 +43,9 @@ int main() {
         return 1;
     }
 
+    TraceScope tracing("client.trace");
     GameState state{};
+    state.trace = tracing.buffer;
 
     while(1) {
         client.main(&state);
@@ -50,13 +50,36 @@ int main() {
     iterators_arrays_RT_test();
     create_and_fetch_arena_in_different_scope_CT_test();
     create_and_fetch_arena_in_different_scope_RT_test();
+    arena_index_test();
     create_hashmap_in_arena_CT_test();
     create_hashmap_in_arena_RT_test();
+    hashmap_churn_test();
+    growable_hashmap_test();
+    hashing_test();
+    key_compare_test();
     quicksort_test();
+    sort_test();
+    radix_sort_test();
+    soa_test();
     create_arena_clear_test();
+    arena_virtual_memory_test();
+    arena_temp_test();
+    arena_alignment_test();
+    pool_test();
+    arena_stats_test();
+    ring_buffer_test();
+    bitset_test();
+    log_test();
+    trace_test();
+    profile_test();
+    benchmark_test();
     gen_sparse_set_ct_test();
     gen_sparse_set_rt_test();
+    paged_gen_sparse_set_test();
+    component_view_test();
     file_io_test();
+    file_view_test();
+    async_io_test();
 
     unload_client(&client);
 }
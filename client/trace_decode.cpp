@@ -0,0 +1,25 @@
+#include "utils.h"
+#include <stdio.h>
+#include <string.h>
+
+// Decodes a binary trace file written by TRACE to text, or to Chrome trace JSON (chrome://tracing, Perfetto)
+// Usage: trace_decode <file.trace> [--chrome <out.json>]
+int main(int argc, char** argv) {
+  if (argc != 2 && !(argc == 4 && strcmp(argv[2], "--chrome") == 0)) {
+    fprintf(stderr, "Usage: %s <file.trace> [--chrome <out.json>]\n", argv[0]);
+    return 1;
+  }
+
+  if (argc == 2) {
+    return trace_decode_text(argv[1], stdout) ? 0 : 1;
+  }
+
+  FILE* out = fopen(argv[3], "wb");
+  if (!out) {
+    LOG_ERROR("Failed opening File: %s", argv[3]);
+    return 1;
+  }
+  bool decoded = trace_decode_chrome(argv[1], out);
+  fclose(out);
+  return decoded ? 0 : 1;
+}
@@ -0,0 +1,558 @@
+#include "utils.h"
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+#ifdef BENCHMARK_ENTT
+  #include "entt.hpp"
+#endif
+
+// Container benchmarks against std:: (and entt when built with BENCHMARK_ENTT) baselines.
+// Built by the containers_benchmark target in client/CMakeLists.txt, always optimized
+// g++ containers_benchmark.cpp utils.cpp -O3 -march=native -o containers_benchmark
+// Usage: containers_benchmark [--filter name] [--max-size n] [--json out.json] [--csv out.csv]
+//                             [--baseline baseline.csv] [--threshold 0.1] [--counters]
+//
+// Every result is for one pass over all n items, names read container/operation/key distribution.
+
+const uint64_t SIZES[] = {16, 64, 256, 1024, 4096, 16384, 65536, 262144, 1048576};
+const uint64_t MAX_LINEAR_SIZE = 4096; // MapCT/MapRT & array find are O(n) per lookup
+using CTSizes = std::integer_sequence<uint32_t, 16, 256, 4096, 65536, 1048576>;
+
+enum class KeyDistribution {
+  Sequential,
+  Random,
+  Strided // Multiples of 4096, every key shares its low bits
+};
+
+const char* key_distribution_name(KeyDistribution distribution) {
+  return distribution == KeyDistribution::Sequential ? "sequential" :
+         distribution == KeyDistribution::Random ? "random" : "strided";
+}
+
+uint64_t splitmix64(uint64_t& state) {
+  uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  return z ^ (z >> 31);
+}
+
+struct Keys {
+  uint64_t* present;
+  uint64_t* absent; // Never inserted, same distribution
+  uint32_t* order; // Shuffled lookup order so lookups don't walk memory in insertion order
+  uint32_t count;
+};
+
+Keys make_keys(Arena& arena, uint32_t count, KeyDistribution distribution) {
+  Keys keys = {arena.alloc_count_raw<uint64_t>(count), arena.alloc_count_raw<uint64_t>(count), arena.alloc_count_raw<uint32_t>(count), count};
+  uint64_t state = 0x5EED;
+  for (uint32_t i = 0; i < count; i++) {
+    if (distribution == KeyDistribution::Sequential) {
+      keys.present[i] = i;
+      keys.absent[i] = count + i;
+    } else if (distribution == KeyDistribution::Random) {
+      keys.present[i] = splitmix64(state) | 1; // Odd & even halves can't collide
+      keys.absent[i] = splitmix64(state) & ~1ull;
+    } else {
+      keys.present[i] = (uint64_t)i << 12;
+      keys.absent[i] = ((uint64_t)(count + i)) << 12;
+    }
+    keys.order[i] = i;
+  }
+  for (uint32_t i = count; i > 1; i--) {
+    uint32_t j = (uint32_t)(splitmix64(state) % i);
+    swap(keys.order[i - 1], keys.order[j]);
+  }
+  return keys;
+}
+
+struct Component {
+  float x, y, z;
+  uint32_t id;
+};
+
+// NOTE: Arrays
+void bench_arrays(BenchmarkSuite& suite, Arena& arena, uint64_t maxSize) {
+  printf("\n=== Arrays ===\n");
+  for (uint64_t n : SIZES) {
+    if (n > maxSize) break;
+    ArenaTemp temp(arena);
+    uint32_t count = (uint32_t)n;
+    ArrayRT<uint64_t>& arr = arena.create_array_rt<uint64_t>(count);
+    std::vector<uint64_t> vec;
+    vec.reserve(count);
+    Keys keys = make_keys(arena, count, KeyDistribution::Random);
+
+    suite.run("array_rt/add", n, [&]() {
+      arr.clear();
+      for (uint32_t i = 0; i < count; i++) arr.add(keys.present[i]);
+      do_not_optimize(arr.elements[count - 1]);
+    });
+    suite.run("std_vector/push_back", n, [&]() {
+      vec.clear();
+      for (uint32_t i = 0; i < count; i++) vec.push_back(keys.present[i]);
+      do_not_optimize(vec.back());
+    });
+
+    suite.run("array_rt/iterate", n, [&]() {
+      uint64_t sum = 0;
+      for (uint64_t value : arr) sum += value;
+      do_not_optimize(sum);
+    });
+    suite.run("std_vector/iterate", n, [&]() {
+      uint64_t sum = 0;
+      for (uint64_t value : vec) sum += value;
+      do_not_optimize(sum);
+    });
+
+    // Swap removes from shuffled positions, the refill is part of every pass for both
+    suite.run("array_rt/fill_remove", n, [&]() {
+      memcpy(arr.elements, keys.present, count * sizeof(uint64_t));
+      arr.count = count;
+      for (uint32_t i = 0; i < count; i++) arr.remove(keys.order[i] % arr.count);
+      do_not_optimize(arr.count);
+    });
+    suite.run("std_vector/fill_remove", n, [&]() {
+      vec.assign(keys.present, keys.present + count);
+      for (uint32_t i = 0; i < count; i++) {
+        uint32_t idx = keys.order[i] % (uint32_t)vec.size();
+        vec[idx] = vec.back();
+        vec.pop_back();
+      }
+      do_not_optimize(vec.size());
+    });
+
+    memcpy(arr.elements, keys.present, count * sizeof(uint64_t));
+    arr.count = count;
+    vec.assign(keys.present, keys.present + count);
+    if (n <= MAX_LINEAR_SIZE) {
+      suite.run("array_rt/find", n, [&]() {
+        uint32_t found = 0;
+        for (uint32_t i = 0; i < count; i++) found += arr.find(keys.present[keys.order[i]]) != UINT32_MAX;
+        do_not_optimize(found);
+      });
+      suite.run("std_vector/find", n, [&]() {
+        uint32_t found = 0;
+        for (uint32_t i = 0; i < count; i++) found += std::find(vec.begin(), vec.end(), keys.present[keys.order[i]]) != vec.end();
+        do_not_optimize(found);
+      });
+    }
+  }
+}
+
+template<uint32_t N>
+void bench_array_ct(BenchmarkSuite& suite, Arena& arena) {
+  ArenaTemp temp(arena);
+  ArrayCT<uint64_t, N>& arr = arena.create_array_ct<uint64_t, N>();
+  Keys keys = make_keys(arena, N, KeyDistribution::Random);
+
+  suite.run("array_ct/add", N, [&]() {
+    arr.clear();
+    for (uint32_t i = 0; i < N; i++) arr.add(keys.present[i]);
+    do_not_optimize(arr.elements[N - 1]);
+  });
+  suite.run("array_ct/iterate", N, [&]() {
+    uint64_t sum = 0;
+    for (uint64_t value : arr) sum += value;
+    do_not_optimize(sum);
+  });
+}
+
+template<uint32_t... N>
+void bench_arrays_ct(BenchmarkSuite& suite, Arena& arena, uint64_t maxSize, std::integer_sequence<uint32_t, N...>) {
+  ((N <= maxSize ? bench_array_ct<N>(suite, arena) : void()), ...);
+}
+
+// NOTE: Maps
+template<typename Map>
+void bench_linear_map(BenchmarkSuite& suite, const char* name, Map& map, const Keys& keys) {
+  char label[64];
+  snprintf(label, sizeof(label), "%s/hit", name);
+  suite.run(label, keys.count, [&]() {
+    uint32_t found = 0;
+    for (uint32_t i = 0; i < keys.count; i++) found += map.find(keys.present[keys.order[i]]) != UINT32_MAX;
+    do_not_optimize(found);
+  });
+  snprintf(label, sizeof(label), "%s/miss", name);
+  suite.run(label, keys.count, [&]() {
+    uint32_t found = 0;
+    for (uint32_t i = 0; i < keys.count; i++) found += map.find(keys.absent[i]) != UINT32_MAX;
+    do_not_optimize(found);
+  });
+}
+
+template<uint32_t N>
+void bench_map_ct(BenchmarkSuite& suite, Arena& arena) {
+  ArenaTemp temp(arena);
+  MapCT<uint64_t, uint64_t, N>& map = arena.create_map_ct<uint64_t, uint64_t, N>();
+  Keys keys = make_keys(arena, N, KeyDistribution::Random);
+  for (uint32_t i = 0; i < N; i++) map[keys.present[i]] = i;
+  bench_linear_map(suite, "map_ct", map, keys);
+}
+
+void bench_maps(BenchmarkSuite& suite, Arena& arena, uint64_t maxSize) {
+  printf("\n=== Maps (linear) ===\n");
+  for (uint64_t n : SIZES) {
+    if (n > maxSize || n > MAX_LINEAR_SIZE) break;
+    ArenaTemp temp(arena);
+    uint32_t count = (uint32_t)n;
+    MapRT<uint64_t, uint64_t>& map = arena.create_map_rt<uint64_t, uint64_t>(count);
+    Keys keys = make_keys(arena, count, KeyDistribution::Random);
+    for (uint32_t i = 0; i < count; i++) map[keys.present[i]] = i;
+    bench_linear_map(suite, "map_rt", map, keys);
+  }
+  if (maxSize >= 16) bench_map_ct<16>(suite, arena);
+  if (maxSize >= 256) bench_map_ct<256>(suite, arena);
+  if (maxSize >= 4096) bench_map_ct<4096>(suite, arena);
+}
+
+// NOTE: Hash maps
+// Insert into an emptied map, hits & misses in shuffled order, and churn: every pass removes all
+// keys & inserts as many new ones, so tombstones pile up & get reused at a steady size.
+template<typename Map>
+void bench_hashmap(BenchmarkSuite& suite, const char* name, Map& map, Keys& keys, KeyDistribution distribution) {
+  const char* dist = key_distribution_name(distribution);
+  uint32_t count = keys.count;
+  char label[64];
+
+  snprintf(label, sizeof(label), "%s/insert/%s", name, dist);
+  suite.run(label, count, [&]() {
+    map.clear();
+    for (uint32_t i = 0; i < count; i++) map[keys.present[i]] = i;
+    do_not_optimize(map.count);
+  });
+
+  snprintf(label, sizeof(label), "%s/hit/%s", name, dist);
+  suite.run(label, count, [&]() {
+    uint64_t sum = 0;
+    for (uint32_t i = 0; i < count; i++) sum += map[keys.present[keys.order[i]]];
+    do_not_optimize(sum);
+  });
+
+  snprintf(label, sizeof(label), "%s/miss/%s", name, dist);
+  suite.run(label, count, [&]() {
+    uint32_t found = 0;
+    for (uint32_t i = 0; i < count; i++) found += map.contains(keys.absent[i]);
+    do_not_optimize(found);
+  });
+
+  snprintf(label, sizeof(label), "%s/churn/%s", name, dist);
+  suite.run(label, count, [&]() {
+    for (uint32_t i = 0; i < count; i++) {
+      map.remove(keys.present[i]);
+      map[keys.absent[i]] = i;
+    }
+    swap(keys.present, keys.absent);
+    do_not_optimize(map.count);
+  });
+}
+
+void bench_std_unordered_map(BenchmarkSuite& suite, std::unordered_map<uint64_t, uint64_t>& map, Keys& keys, KeyDistribution distribution) {
+  const char* dist = key_distribution_name(distribution);
+  uint32_t count = keys.count;
+  char label[64];
+
+  snprintf(label, sizeof(label), "std_unordered_map/insert/%s", dist);
+  suite.run(label, count, [&]() {
+    map.clear();
+    for (uint32_t i = 0; i < count; i++) map[keys.present[i]] = i;
+    do_not_optimize(map.size());
+  });
+
+  snprintf(label, sizeof(label), "std_unordered_map/hit/%s", dist);
+  suite.run(label, count, [&]() {
+    uint64_t sum = 0;
+    for (uint32_t i = 0; i < count; i++) sum += map.find(keys.present[keys.order[i]])->second;
+    do_not_optimize(sum);
+  });
+
+  snprintf(label, sizeof(label), "std_unordered_map/miss/%s", dist);
+  suite.run(label, count, [&]() {
+    uint32_t found = 0;
+    for (uint32_t i = 0; i < count; i++) found += map.find(keys.absent[i]) != map.end();
+    do_not_optimize(found);
+  });
+
+  snprintf(label, sizeof(label), "std_unordered_map/churn/%s", dist);
+  suite.run(label, count, [&]() {
+    for (uint32_t i = 0; i < count; i++) {
+      map.erase(keys.present[i]);
+      map[keys.absent[i]] = i;
+    }
+    swap(keys.present, keys.absent);
+    do_not_optimize(map.size());
+  });
+}
+
+template<uint32_t N>
+void bench_hashmap_ct(BenchmarkSuite& suite, Arena& arena) {
+  ArenaTemp temp(arena);
+  HashMapCT<uint64_t, uint64_t, N * 2>& map = arena.create_hashmap_ct<uint64_t, uint64_t, N * 2>(); // Stays under the max load factor
+  Keys keys = make_keys(arena, N, KeyDistribution::Random);
+  bench_hashmap(suite, "hashmap_ct", map, keys, KeyDistribution::Random);
+}
+
+template<uint32_t... N>
+void bench_hashmaps_ct(BenchmarkSuite& suite, Arena& arena, uint64_t maxSize, std::integer_sequence<uint32_t, N...>) {
+  ((N <= maxSize ? bench_hashmap_ct<N>(suite, arena) : void()), ...);
+}
+
+void bench_hashmaps(BenchmarkSuite& suite, Arena& arena, uint64_t maxSize) {
+  printf("\n=== Hash maps ===\n");
+  const KeyDistribution distributions[] = {KeyDistribution::Sequential, KeyDistribution::Random, KeyDistribution::Strided};
+  for (KeyDistribution distribution : distributions) {
+    for (uint64_t n : SIZES) {
+      if (n > maxSize) break;
+      ArenaTemp temp(arena);
+      uint32_t count = (uint32_t)n;
+      HashMapRT<uint64_t, uint64_t>& map = arena.create_hashmap_rt<uint64_t, uint64_t>(count * 2);
+      Keys keys = make_keys(arena, count, distribution);
+      bench_hashmap(suite, "hashmap_rt", map, keys, distribution);
+
+      std::unordered_map<uint64_t, uint64_t> stdMap;
+      stdMap.reserve(count);
+      keys = make_keys(arena, count, distribution);
+      bench_std_unordered_map(suite, stdMap, keys, distribution);
+    }
+  }
+  bench_hashmaps_ct(suite, arena, maxSize, CTSizes{});
+}
+
+// NOTE: Generational sparse sets
+template<typename Set, typename Ids>
+void bench_sparse_set(BenchmarkSuite& suite, const char* name, Set& set, Ids& ids, const Keys& keys) {
+  uint32_t count = keys.count;
+  char label[64];
+
+  snprintf(label, sizeof(label), "%s/add", name);
+  suite.run(label, count, [&]() {
+    set.clear();
+    for (uint32_t i = 0; i < count; i++) ids[i] = set.add(Component{(float)i, 0.0f, 0.0f, i});
+    do_not_optimize(ids[count - 1]);
+  });
+
+  snprintf(label, sizeof(label), "%s/get", name);
+  suite.run(label, count, [&]() {
+    uint32_t sum = 0;
+    for (uint32_t i = 0; i < count; i++) sum += set.get(ids[keys.order[i]])->id;
+    do_not_optimize(sum);
+  });
+
+  snprintf(label, sizeof(label), "%s/iterate", name);
+  suite.run(label, count, [&]() {
+    float sum = 0.0f;
+    for (Component& component : set) sum += component.x;
+    do_not_optimize(sum);
+  });
+
+  snprintf(label, sizeof(label), "%s/remove_add", name);
+  suite.run(label, count, [&]() {
+    for (uint32_t i = 0; i < count; i++) {
+      uint32_t idx = keys.order[i];
+      set.remove(ids[idx]);
+      ids[idx] = set.add(Component{0.0f, 0.0f, 0.0f, idx});
+    }
+    do_not_optimize(set.size());
+  });
+}
+
+template<uint32_t N>
+void bench_sparse_set_ct(BenchmarkSuite& suite, Arena& arena) {
+  ArenaTemp temp(arena);
+  GenSparseSetCT<Component, N>& set = arena.create_gen_sparse_set_ct<Component, N>();
+  GenId* ids = arena.alloc_count_raw<GenId>(N);
+  Keys keys = make_keys(arena, N, KeyDistribution::Random);
+  bench_sparse_set(suite, "gen_sparse_set_ct", set, ids, keys);
+}
+
+template<uint32_t... N>
+void bench_sparse_sets_ct(BenchmarkSuite& suite, Arena& arena, uint64_t maxSize, std::integer_sequence<uint32_t, N...>) {
+  ((N <= maxSize ? bench_sparse_set_ct<N>(suite, arena) : void()), ...);
+}
+
+#ifdef BENCHMARK_ENTT
+void bench_entt(BenchmarkSuite& suite, uint32_t count, const Keys& keys) {
+  entt::registry registry;
+  std::vector<entt::entity> entities(count);
+
+  suite.run("entt/add", count, [&]() {
+    registry.clear();
+    for (uint32_t i = 0; i < count; i++) {
+      entities[i] = registry.create();
+      registry.emplace<Component>(entities[i], Component{(float)i, 0.0f, 0.0f, i});
+    }
+    do_not_optimize(entities[count - 1]);
+  });
+
+  suite.run("entt/get", count, [&]() {
+    uint32_t sum = 0;
+    for (uint32_t i = 0; i < count; i++) sum += registry.get<Component>(entities[keys.order[i]]).id;
+    do_not_optimize(sum);
+  });
+
+  suite.run("entt/iterate", count, [&]() {
+    float sum = 0.0f;
+    registry.view<Component>().each([&](Component& component) { sum += component.x; });
+    do_not_optimize(sum);
+  });
+
+  suite.run("entt/remove_add", count, [&]() {
+    for (uint32_t i = 0; i < count; i++) {
+      uint32_t idx = keys.order[i];
+      registry.destroy(entities[idx]);
+      entities[idx] = registry.create();
+      registry.emplace<Component>(entities[idx], Component{0.0f, 0.0f, 0.0f, idx});
+    }
+    do_not_optimize(entities[0]);
+  });
+}
+#endif
+
+void bench_sparse_sets(BenchmarkSuite& suite, Arena& arena, uint64_t maxSize) {
+  printf("\n=== Generational sparse sets ===\n");
+  for (uint64_t n : SIZES) {
+    if (n > maxSize) break;
+    ArenaTemp temp(arena);
+    uint32_t count = (uint32_t)n;
+    GenSparseSetRT<Component>& set = arena.create_gen_sparse_set_rt<Component>(count);
+    GenId* ids = arena.alloc_count_raw<GenId>(count);
+    Keys keys = make_keys(arena, count, KeyDistribution::Random);
+    bench_sparse_set(suite, "gen_sparse_set_rt", set, ids, keys);
+#ifdef BENCHMARK_ENTT
+    bench_entt(suite, count, keys);
+#endif
+  }
+  bench_sparse_sets_ct(suite, arena, maxSize, CTSizes{});
+}
+
+// NOTE: Arena
+void bench_arena(BenchmarkSuite& suite, uint64_t maxSize) {
+  printf("\n=== Arena ===\n");
+  struct Object {
+    uint64_t data[4];
+  };
+
+  for (uint64_t n : SIZES) {
+    if (n > maxSize) break;
+    uint32_t count = (uint32_t)n;
+    Arena arena(n * sizeof(Object) + KB(64));
+    std::vector<Object*> pointers(count);
+
+    suite.run("arena/alloc_clear", n, [&]() {
+      for (uint32_t i = 0; i < count; i++) pointers[i] = &arena.alloc<Object>();
+      do_not_optimize(pointers[count - 1]);
+      arena.clear(ArenaClear::NoZero);
+    });
+    suite.run("arena/alloc_clear_zero", n, [&]() { // The default clear zeroes what was used
+      for (uint32_t i = 0; i < count; i++) pointers[i] = &arena.alloc<Object>();
+      do_not_optimize(pointers[count - 1]);
+      arena.clear();
+    });
+    suite.run("malloc_free", n, [&]() {
+      for (uint32_t i = 0; i < count; i++) pointers[i] = (Object*)malloc(sizeof(Object));
+      do_not_optimize(pointers[count - 1]);
+      for (uint32_t i = 0; i < count; i++) free(pointers[i]);
+    });
+  }
+}
+
+// NOTE: Sorting
+// Each pass copies the unsorted input back first, the copy is included for every algorithm
+void bench_sort(BenchmarkSuite& suite, Arena& arena, uint64_t maxSize) {
+  printf("\n=== Sorting ===\n");
+  for (uint64_t n : SIZES) {
+    if (n > maxSize) break;
+    ArenaTemp temp(arena);
+    uint32_t count = (uint32_t)n;
+    uint32_t* input = arena.alloc_count_raw<uint32_t>(count);
+    uint64_t state = n;
+    for (uint32_t i = 0; i < count; i++) input[i] = (uint32_t)splitmix64(state);
+    ArrayRT<uint32_t>& arr = arena.create_array_rt<uint32_t>(count);
+    arr.count = count;
+    std::vector<uint32_t> vec(count);
+
+    suite.run("quicksort/random", n, [&]() {
+      memcpy(arr.elements, input, count * sizeof(uint32_t));
+      quicksort(arr);
+      do_not_optimize(arr.elements[0]);
+    });
+    suite.run("radix_sort/random", n, [&]() {
+      memcpy(arr.elements, input, count * sizeof(uint32_t));
+      radix_sort(arr, arena);
+      do_not_optimize(arr.elements[0]);
+    });
+    suite.run("std_sort/random", n, [&]() {
+      memcpy(vec.data(), input, count * sizeof(uint32_t));
+      std::sort(vec.begin(), vec.end());
+      do_not_optimize(vec[0]);
+    });
+
+    for (uint32_t i = 0; i < count; i++) input[i] = i ^ (i % 16 == 0 ? 1 : 0); // Nearly sorted
+    suite.run("quicksort/nearly_sorted", n, [&]() {
+      memcpy(arr.elements, input, count * sizeof(uint32_t));
+      quicksort(arr);
+      do_not_optimize(arr.elements[0]);
+    });
+    suite.run("std_sort/nearly_sorted", n, [&]() {
+      memcpy(vec.data(), input, count * sizeof(uint32_t));
+      std::sort(vec.begin(), vec.end());
+      do_not_optimize(vec[0]);
+    });
+  }
+}
+
+int main(int argc, char *argv[]) {
+  const char* jsonPath = nullptr;
+  const char* csvPath = nullptr;
+  const char* baselinePath = nullptr;
+  double threshold = 0.1;
+  uint64_t maxSize = SIZES[sizeof(SIZES) / sizeof(SIZES[0]) - 1];
+  bool counters = false;
+  BenchmarkSuite suite;
+  suite.config.warmupMs = 10.0;
+  suite.config.samples = 15;
+  suite.config.maxSeconds = 1.0;
+  suite.config.paramIsItems = true;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--counters") == 0) {
+      counters = true;
+      continue;
+    }
+    if (i + 1 >= argc) {
+      LOG_WARN("Missing value for %s", argv[i]);
+      break;
+    }
+    if (strcmp(argv[i], "--filter") == 0) suite.filter = argv[i + 1];
+    else if (strcmp(argv[i], "--max-size") == 0) maxSize = strtoull(argv[i + 1], nullptr, 10);
+    else if (strcmp(argv[i], "--json") == 0) jsonPath = argv[i + 1];
+    else if (strcmp(argv[i], "--csv") == 0) csvPath = argv[i + 1];
+    else if (strcmp(argv[i], "--baseline") == 0) baselinePath = argv[i + 1];
+    else if (strcmp(argv[i], "--threshold") == 0) threshold = atof(argv[i + 1]);
+    else LOG_WARN("Unknown option %s", argv[i]);
+    i++;
+  }
+
+  printf("Running container benchmarks up to %llu items (timer %.3f ticks/ns)...\n", (unsigned long long)maxSize, benchmark_ticks_per_ns());
+  if (counters && !suite.enable_counters()) {
+    LOG_WARN("Hardware counters unavailable (not Linux, no PMU or perf_event_paranoid too high), timing only");
+  }
+#ifndef BENCHMARK_ENTT
+  LOG_WARN("Built without entt, set ENTT_INCLUDE_DIR for the entt baselines");
+#endif
+
+  Arena arena(GB(2)); // Reserved only, pages commit as the sizes grow
+  bench_arrays(suite, arena, maxSize);
+  bench_arrays_ct(suite, arena, maxSize, CTSizes{});
+  bench_maps(suite, arena, maxSize);
+  bench_hashmaps(suite, arena, maxSize);
+  bench_sparse_sets(suite, arena, maxSize);
+  bench_arena(suite, maxSize);
+  bench_sort(suite, arena, maxSize);
+
+  if (jsonPath) suite.write_json(jsonPath);
+  if (csvPath) suite.write_csv(csvPath);
+  uint32_t regressions = baselinePath ? suite.compare_baseline(baselinePath, threshold) : 0;
+  if (regressions) LOG_ERROR("%u benchmarks regressed beyond %.0f%%", regressions, threshold * 100.0);
+  return regressions ? 1 : 0;
+}
@@ -2,6 +2,771 @@
 #include <cctype>
 #include <cstdint>
 #include <cstdio>
+#include <ctime>
+#include <condition_variable>
+#include <mutex>
+
+#ifdef _WIN32
+  #include <fcntl.h>
+  #include <io.h>
+  #include <sys/stat.h>
+#else
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <unistd.h>
+#endif
+#ifdef __linux__
+  #include <linux/io_uring.h>
+  #include <linux/perf_event.h>
+  #include <sys/syscall.h>
+#endif
+
+// NOTE: Logging
+struct Logger {
+  static constexpr uint32_t maxQueues = 64; // Threads logging at once, others fall back to writing synchronously
+  static constexpr uint32_t queueCapacity = 1024;
+
+  std::atomic<bool> running{false};
+  std::thread thread;
+  std::mutex startMutex;
+  std::mutex drainMutex; // One consumer at a time, either the log thread or a flush
+  std::mutex registerMutex;
+  Arena arena{64 * 1024 * 1024}; // Reserved only, queues commit as threads register
+  std::atomic<SPSCQueueRT<LogRecord>*> queues[maxQueues] = {}; // Null until the slot's first owner creates it
+  std::atomic<bool> claimed[maxQueues] = {};
+  std::atomic<uint32_t> queueCount{0}; // Upper bound on created slots, lower slots may still be null
+  std::atomic<uint64_t> dropped{0};
+  LogSink sink = nullptr;
+  void* sinkUser = nullptr;
+};
+
+static Logger& logger() {
+  static Logger* instance = new Logger; // Never freed, threads may still log during static destruction
+  return *instance;
+}
+
+// Hands its queue back when the thread exits so short lived worker threads don't use up the slots
+struct LogThreadQueue {
+  int32_t slot = -1;
+  bool unavailable = false;
+
+  ~LogThreadQueue() {
+    if (slot >= 0) logger().claimed[slot].store(false, std::memory_order_release);
+  }
+};
+
+static thread_local LogThreadQueue logThreadQueue;
+
+static SPSCQueueRT<LogRecord>* log_thread_queue(Logger& log) {
+  if (logThreadQueue.slot >= 0) return log.queues[logThreadQueue.slot].load(std::memory_order_relaxed);
+  if (logThreadQueue.unavailable) return nullptr;
+
+  for (uint32_t i = 0; i < Logger::maxQueues; i++) {
+    bool expected = false;
+    if (log.claimed[i].load(std::memory_order_relaxed) ||
+        !log.claimed[i].compare_exchange_strong(expected, true, std::memory_order_acquire)) continue;
+
+    SPSCQueueRT<LogRecord>* queue = log.queues[i].load(std::memory_order_acquire);
+    if (!queue) {
+      std::lock_guard<std::mutex> lock(log.registerMutex);
+      queue = &log.arena.create_spsc_queue_rt<LogRecord>(Logger::queueCapacity);
+      log.queues[i].store(queue, std::memory_order_release);
+      if (log.queueCount.load(std::memory_order_relaxed) < i + 1) log.queueCount.store(i + 1, std::memory_order_release);
+    }
+    logThreadQueue.slot = (int32_t)i;
+    return queue;
+  }
+  logThreadQueue.unavailable = true;
+  return nullptr;
+}
+
+static void log_write(Logger& log, const LogRecord& record) {
+  const static char* TextColorTable[TEXT_COLOR_COUNT] = 
+  {    
+    "\x1b[30m", // TEXT_COLOR_BLACK
+    "\x1b[31m", // TEXT_COLOR_RED
+    "\x1b[32m", // TEXT_COLOR_GREEN
+    "\x1b[33m", // TEXT_COLOR_YELLOW
+    "\x1b[34m", // TEXT_COLOR_BLUE
+    "\x1b[35m", // TEXT_COLOR_MAGENTA
+    "\x1b[36m", // TEXT_COLOR_CYAN
+    "\x1b[37m", // TEXT_COLOR_WHITE
+    "\x1b[90m", // TEXT_COLOR_BRIGHT_BLACK
+    "\x1b[91m", // TEXT_COLOR_BRIGHT_RED
+    "\x1b[92m", // TEXT_COLOR_BRIGHT_GREEN
+    "\x1b[93m", // TEXT_COLOR_BRIGHT_YELLOW
+    "\x1b[94m", // TEXT_COLOR_BRIGHT_BLUE
+    "\x1b[95m", // TEXT_COLOR_BRIGHT_MAGENTA
+    "\x1b[96m", // TEXT_COLOR_BRIGHT_CYAN
+    "\x1b[97m", // TEXT_COLOR_BRIGHT_WHITE
+  };
+  const static char* prefixes[] = {"TRACE: ", "WARN: ", "ERROR: "};
+  const static TextColor colors[] = {TEXT_COLOR_GREEN, TEXT_COLOR_YELLOW, TEXT_COLOR_RED};
+
+  char message[4096];
+  record.format(record, message, sizeof(message));
+
+  uint32_t level = (uint32_t)record.level;
+  const char* channel = record.channel->name;
+  char line[8192];
+  if (channel && channel[0]) {
+    snprintf(line, sizeof(line), "%s %s[%s] %s \033[0m", TextColorTable[colors[level]], prefixes[level], channel, message);
+  } else {
+    snprintf(line, sizeof(line), "%s %s %s \033[0m", TextColorTable[colors[level]], prefixes[level], message);
+  }
+
+  if (log.sink) {
+    log.sink(line, record.level, log.sinkUser);
+  } else {
+    puts(line);
+  }
+}
+
+// Caller holds drainMutex
+static bool log_drain(Logger& log) {
+  bool wrote = false;
+  uint32_t count = log.queueCount.load(std::memory_order_acquire);
+  LogRecord record;
+  for (uint32_t i = 0; i < count; i++) {
+    SPSCQueueRT<LogRecord>* queue = log.queues[i].load(std::memory_order_acquire);
+    if (!queue) continue; // Claimed, its owner hasn't created it yet
+    while (queue->try_pop(record)) {
+      log_write(log, record);
+      wrote = true;
+    }
+  }
+
+  uint64_t dropped = log.dropped.exchange(0, std::memory_order_relaxed);
+  if (dropped) {
+    LogRecord notice = {};
+    notice.format = &log_format<unsigned long long>;
+    notice.msg = "%llu log records dropped, queue full";
+    notice.channel = &logDefault;
+    notice.level = LogLevel::Warn;
+    unsigned long long value = dropped;
+    memcpy(notice.payload, &value, sizeof(value));
+    log_write(log, notice);
+  }
+  if (wrote || dropped) fflush(stdout);
+  return wrote;
+}
+
+static void log_thread(Logger* log) {
+  while (log->running.load(std::memory_order_acquire)) {
+    bool wrote;
+    {
+      std::lock_guard<std::mutex> lock(log->drainMutex);
+      wrote = log_drain(*log);
+    }
+    if (!wrote) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+
+void log_submit(const LogRecord& record) {
+  Logger& log = logger();
+  SPSCQueueRT<LogRecord>* queue = log.running.load(std::memory_order_acquire) ? log_thread_queue(log) : nullptr;
+  if (!queue) {
+    std::lock_guard<std::mutex> lock(log.drainMutex);
+    log_write(log, record);
+    return;
+  }
+
+  if (record.level == LogLevel::Error) {
+    queue->push(record); // Errors wait for room rather than getting lost
+  } else if (!queue->try_push(record)) {
+    log.dropped.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void log_flush() {
+  Logger& log = logger();
+  std::lock_guard<std::mutex> lock(log.drainMutex);
+  log_drain(log);
+  fflush(stdout);
+}
+
+void log_start() {
+  Logger& log = logger();
+  std::lock_guard<std::mutex> lock(log.startMutex);
+  if (log.running.load(std::memory_order_relaxed)) return;
+  log.running.store(true, std::memory_order_release);
+  log.thread = std::thread(log_thread, &log);
+}
+
+void log_stop() {
+  Logger& log = logger();
+  std::lock_guard<std::mutex> lock(log.startMutex);
+  if (!log.running.load(std::memory_order_relaxed)) return;
+  log.running.store(false, std::memory_order_release);
+  log.thread.join();
+  log_flush();
+}
+
+void log_set_sink(LogSink sink, void* user) {
+  Logger& log = logger();
+  std::lock_guard<std::mutex> lock(log.drainMutex);
+  log.sink = sink;
+  log.sinkUser = user;
+}
+
+// NOTE: Binary trace
+struct TraceFileHeader {
+  std::atomic<uint64_t> writePos;
+  char magic[8];
+  uint32_t version;
+  uint32_t recordCount;
+  uint32_t siteCapacity;
+  uint32_t siteCount;
+  uint64_t startTsc;
+  uint64_t startNs; // Steady clock
+  uint64_t endTsc;
+  double ticksPerNs; // Calibrated on open, refined on close
+  uint64_t sitesOffset;
+  uint64_t recordsOffset;
+};
+
+struct TraceSiteEntry { // Site ids start at 1, entry 0 is unused
+  uint32_t line;
+  char signature[16];
+  char file[172];
+  char format[320];
+};
+static_assert(sizeof(TraceSiteEntry) == 512, "Trace site entries are fixed size");
+
+static const char traceMagic[8] = {'S', 'B', 'T', 'R', 'A', 'C', 'E', 0};
+static constexpr uint32_t traceVersion = 1;
+static constexpr uint32_t traceSiteCapacity = 4096;
+static constexpr uint64_t traceHeaderSize = 4096;
+
+static std::atomic<uint16_t> traceSerial{0};
+
+static uint64_t trace_steady_ns() {
+  return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static double trace_calibrate(const TraceFileHeader& header) {
+  uint64_t ticks = read_cycle_counter() - header.startTsc;
+  uint64_t ns = trace_steady_ns() - header.startNs;
+  return ns && ticks ? (double)ticks / (double)ns : 1.0;
+}
+
+TraceBuffer* trace_open(const char* path, uint32_t recordCount) {
+  LOG_ASSERT(path, "No trace path supplied!");
+  uint32_t count = 1;
+  while (count < recordCount) count <<= 1;
+  uint64_t sitesOffset = traceHeaderSize;
+  uint64_t recordsOffset = sitesOffset + (uint64_t)traceSiteCapacity * sizeof(TraceSiteEntry);
+  uint64_t fileSize = recordsOffset + (uint64_t)count * sizeof(TraceRecord);
+
+#ifdef _WIN32
+  HANDLE file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    LOG_ERROR("Failed opening trace file: %s", path);
+    return nullptr;
+  }
+  HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE, (DWORD)(fileSize >> 32), (DWORD)fileSize, nullptr);
+  CloseHandle(file);
+  char* memory = mapping ? (char*)MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, fileSize) : nullptr;
+  if (!memory) {
+    if (mapping) CloseHandle(mapping);
+    LOG_ERROR("Failed mapping trace file: %s", path);
+    return nullptr;
+  }
+#else
+  int file = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (file < 0) {
+    LOG_ERROR("Failed opening trace file: %s", path);
+    return nullptr;
+  }
+  char* memory = nullptr;
+  if (ftruncate(file, (off_t)fileSize) == 0) {
+    void* mapped = mmap(nullptr, fileSize, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+    if (mapped != MAP_FAILED) memory = (char*)mapped;
+  }
+  close(file); // The mapping keeps the file alive
+  if (!memory) {
+    LOG_ERROR("Failed mapping trace file: %s", path);
+    return nullptr;
+  }
+  void* mapping = nullptr;
+#endif
+
+  // The file is freshly truncated so everything past the header reads as zero
+  TraceFileHeader* header = new (memory) TraceFileHeader{};
+  memcpy(header->magic, traceMagic, sizeof(traceMagic));
+  header->version = traceVersion;
+  header->recordCount = count;
+  header->siteCapacity = traceSiteCapacity;
+  header->sitesOffset = sitesOffset;
+  header->recordsOffset = recordsOffset;
+
+  header->startNs = trace_steady_ns();
+  header->startTsc = read_cycle_counter();
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  header->ticksPerNs = trace_calibrate(*header);
+
+  TraceBuffer* buffer = new TraceBuffer{};
+  buffer->header = header;
+  buffer->writePos = &header->writePos;
+  buffer->records = (TraceRecord*)(memory + recordsOffset);
+  buffer->mask = count - 1;
+  buffer->fileSize = fileSize;
+  buffer->mapping = mapping;
+  uint16_t serial = traceSerial.fetch_add(1, std::memory_order_relaxed) + 1;
+  buffer->serial = serial ? serial : traceSerial.fetch_add(1, std::memory_order_relaxed) + 1; // 0 marks unregistered sites
+  traceActive = buffer;
+  return buffer;
+}
+
+void trace_close(TraceBuffer* buffer) {
+  if (!buffer) return;
+  if (traceActive == buffer) traceActive = nullptr;
+
+  TraceFileHeader* header = buffer->header;
+  header->endTsc = read_cycle_counter();
+  header->ticksPerNs = trace_calibrate(*header);
+#ifdef _WIN32
+  UnmapViewOfFile(header);
+  CloseHandle((HANDLE)buffer->mapping);
+#else
+  munmap(header, buffer->fileSize);
+#endif
+  delete buffer;
+}
+
+void trace_attach(TraceBuffer* buffer) {
+  traceActive = buffer;
+}
+
+uint16_t trace_register(TraceBuffer& buffer, TraceSite& site, const char* signature) {
+  while (buffer.registering.exchange(true, std::memory_order_acquire)) std::this_thread::yield();
+
+  // Another thread may have registered the site while we waited
+  uint32_t key = site.key.load(std::memory_order_relaxed);
+  uint16_t id = (key >> 16) == buffer.serial ? (uint16_t)key : 0;
+  TraceFileHeader* header = buffer.header;
+  if (!id && header->siteCount + 1 < header->siteCapacity) {
+    id = (uint16_t)++header->siteCount;
+    TraceSiteEntry& entry = ((TraceSiteEntry*)((char*)header + header->sitesOffset))[id];
+    entry.line = site.line;
+    snprintf(entry.signature, sizeof(entry.signature), "%s", signature);
+    snprintf(entry.file, sizeof(entry.file), "%s", site.file);
+    snprintf(entry.format, sizeof(entry.format), "%s", site.format);
+    site.key.store(((uint32_t)buffer.serial << 16) | id, std::memory_order_relaxed);
+  }
+
+  buffer.registering.store(false, std::memory_order_release);
+  return id;
+}
+
+uint32_t trace_os_thread_id() {
+#ifdef _WIN32
+  return (uint32_t)GetCurrentThreadId();
+#elif defined(__linux__)
+  return (uint32_t)syscall(SYS_gettid);
+#else
+  return (uint32_t)(uintptr_t)pthread_self();
+#endif
+}
+
+// Formats one record using the site's printf format. Each conversion gets the stored argument
+// converted to what the conversion expects, so a mismatched format can't read garbage.
+static void trace_format(const TraceSiteEntry& site, const TraceRecord& record, char* out, uint32_t size) {
+  const char* cursor = record.payload;
+  const char* payloadEnd = record.payload + record.size;
+  const char* signature = site.signature;
+  uint32_t used = 0;
+  auto append = [&](int written) {
+    if (written > 0) used = std::min<uint32_t>(used + written, size - 1);
+  };
+
+  for (const char* f = site.format; *f && used < size - 1; f++) {
+    if (*f != '%') {
+      out[used++] = *f;
+      continue;
+    }
+    if (f[1] == '%') {
+      out[used++] = '%';
+      f++;
+      continue;
+    }
+
+    // Rebuild the spec without length modifiers, the stored type decides those
+    char spec[32] = {'%'};
+    uint32_t specLength = 1;
+    f++;
+    while (*f && strchr("-+ #0123456789.*", *f) && specLength < sizeof(spec) - 4) spec[specLength++] = *f++;
+    while (*f && strchr("hlLqjzt", *f)) f++;
+    char conversion = *f;
+    if (!conversion) break;
+
+    char code = *signature ? *signature++ : 0;
+    uint64_t raw = 0;
+    char text[256] = {};
+    if (code == 's' && cursor < payloadEnd) {
+      uint32_t length = (uint8_t)*cursor++;
+      memcpy(text, cursor, std::min<uint32_t>(length, (uint32_t)(payloadEnd - cursor)));
+      cursor += length;
+    } else if (code) {
+      uint32_t width = trace_code_size(code);
+      if (cursor + width <= payloadEnd) memcpy(&raw, cursor, width);
+      cursor += width;
+    }
+
+    double real = code == 'd' ? 0.0 : (code == 'i' ? (double)(int32_t)raw : code == 'I' ? (double)(int64_t)raw : (double)raw);
+    if (code == 'd') memcpy(&real, &raw, sizeof(real));
+    int64_t integer = code == 'd' ? (int64_t)real : code == 'i' ? (int64_t)(int32_t)raw : (int64_t)raw;
+
+    if (strchr("eEfFgGaA", conversion)) {
+      spec[specLength++] = conversion;
+      append(snprintf(out + used, size - used, spec, real));
+    } else if (conversion == 's') {
+      spec[specLength++] = 's';
+      append(snprintf(out + used, size - used, spec, code == 's' ? text : "?"));
+    } else if (conversion == 'p') {
+      append(snprintf(out + used, size - used, "0x%llx", (unsigned long long)raw));
+    } else if (conversion == 'c') {
+      spec[specLength++] = 'c';
+      append(snprintf(out + used, size - used, spec, (int)integer));
+    } else {
+      spec[specLength++] = 'l';
+      spec[specLength++] = 'l';
+      spec[specLength++] = strchr("diouxX", conversion) ? conversion : 'd';
+      append(snprintf(out + used, size - used, spec, (long long)integer));
+    }
+  }
+  out[used] = 0;
+}
+
+struct TraceFile {
+  const TraceFileHeader* header;
+  const TraceSiteEntry* sites;
+  const TraceRecord** records; // Valid records oldest first
+  uint32_t count;
+};
+
+static bool trace_load(const char* path, const FileView& file, Arena& arena, TraceFile& trace) {
+  uint64_t fileSize = file.size;
+  const char* data = file.data;
+  const TraceFileHeader* header = (const TraceFileHeader*)data;
+  if (fileSize < sizeof(TraceFileHeader) || memcmp(header->magic, traceMagic, sizeof(traceMagic)) || header->version != traceVersion ||
+      header->recordsOffset + (uint64_t)header->recordCount * sizeof(TraceRecord) > fileSize) {
+    LOG_ERROR("Not a trace file: %s", path);
+    return false;
+  }
+
+  trace.header = header;
+  trace.sites = (const TraceSiteEntry*)(data + header->sitesOffset);
+  trace.records = arena.alloc_count_raw<const TraceRecord*>(header->recordCount);
+  trace.count = 0;
+
+  // A record counts when its sequence lands on its own slot, torn or lapped writes don't
+  const TraceRecord* records = (const TraceRecord*)(data + header->recordsOffset);
+  uint64_t mask = header->recordCount - 1;
+  for (uint32_t i = 0; i < header->recordCount; i++) {
+    const TraceRecord& record = records[i];
+    uint64_t seq = record.seq.load(std::memory_order_relaxed);
+    if (!seq || ((seq - 1) & mask) != i || !record.site || record.site > header->siteCount || record.size > TraceRecord::payloadSize) continue;
+    trace.records[trace.count++] = &record;
+  }
+  radix_sort(trace.records, trace.records + trace.count, arena, [](const TraceRecord* record) { return record->seq.load(std::memory_order_relaxed); });
+  return true;
+}
+
+static double trace_time_us(const TraceFile& trace, const TraceRecord& record) {
+  return (double)(int64_t)(record.tsc - trace.header->startTsc) / trace.header->ticksPerNs / 1000.0;
+}
+
+bool trace_decode_text(const char* path, FILE* out) {
+  FileViewScope file(path, FileAdvice::Sequential); // Read in place, the records are never copied
+  if (!file.mapped) return false;
+  Arena arena(file.view.size / 2 + MB(1)); // Sorted record pointers & radix scratch, 8 bytes each per 64 byte record
+  TraceFile trace;
+  if (!trace_load(path, file.view, arena, trace)) return false;
+
+  char message[1024];
+  for (uint32_t i = 0; i < trace.count; i++) {
+    const TraceRecord& record = *trace.records[i];
+    const TraceSiteEntry& site = trace.sites[record.site];
+    trace_format(site, record, message, sizeof(message));
+    fprintf(out, "%12.3f us [%u] %s:%u %s\n", trace_time_us(trace, record), record.thread, site.file, site.line, message);
+  }
+  return true;
+}
+
+static void trace_write_json_string(FILE* out, const char* text) {
+  fputc('"', out);
+  for (; *text; text++) {
+    unsigned char c = (unsigned char)*text;
+    if (c == '"' || c == '\\') fprintf(out, "\\%c", c);
+    else if (c < 0x20) fprintf(out, "\\u%04x", c);
+    else fputc(c, out);
+  }
+  fputc('"', out);
+}
+
+bool trace_decode_chrome(const char* path, FILE* out) {
+  FileViewScope file(path, FileAdvice::Sequential); // Read in place, the records are never copied
+  if (!file.mapped) return false;
+  Arena arena(file.view.size / 2 + MB(1)); // Sorted record pointers & radix scratch, 8 bytes each per 64 byte record
+  TraceFile trace;
+  if (!trace_load(path, file.view, arena, trace)) return false;
+
+  char message[1024];
+  fprintf(out, "{\"traceEvents\":[\n");
+  for (uint32_t i = 0; i < trace.count; i++) {
+    const TraceRecord& record = *trace.records[i];
+    const TraceSiteEntry& site = trace.sites[record.site];
+    trace_format(site, record, message, sizeof(message));
+    fprintf(out, "%s{\"name\":", i ? ",\n" : "");
+    trace_write_json_string(out, message);
+    fprintf(out, ",\"ph\":\"i\",\"s\":\"t\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"args\":{\"site\":", record.thread, trace_time_us(trace, record));
+    trace_write_json_string(out, site.file);
+    fprintf(out, ",\"line\":%u}}", site.line);
+  }
+  fprintf(out, "\n]}\n");
+  return true;
+}
+
+// NOTE: Profiler
+static std::atomic<uint16_t> profilerSerial{0};
+
+Profiler* profiler_create(Arena& arena, uint32_t eventsPerThread) {
+  uint64_t count = 1;
+  while (count < eventsPerThread) count <<= 1;
+  Profiler* profiler = new (arena.alloc_raw<Profiler>()) Profiler{};
+  profiler->arena = &arena;
+  profiler->eventsPerThread = count;
+  profiler->startNs = trace_steady_ns();
+  profiler->startTsc = read_cycle_counter();
+  uint16_t serial = profilerSerial.fetch_add(1, std::memory_order_relaxed) + 1;
+  profiler->serial = serial ? serial : profilerSerial.fetch_add(1, std::memory_order_relaxed) + 1; // 0 marks unregistered sites
+  profilerActive = profiler;
+  return profiler;
+}
+
+void profiler_attach(Profiler* profiler) {
+  profilerActive = profiler;
+}
+
+ProfileThread* profile_register_thread(Profiler& profiler) {
+  while (profiler.registering.exchange(true, std::memory_order_acquire)) std::this_thread::yield();
+
+  // A reloaded library comes back on the same thread, it keeps that thread's ring & open zone depth
+  uint32_t osThreadId = trace_os_thread_id();
+  ProfileThread* thread = nullptr;
+  for (uint32_t i = 0; i < profiler.threadCount && !thread; i++) {
+    if (profiler.threads[i]->osThreadId == osThreadId) thread = profiler.threads[i];
+  }
+
+  Arena& arena = *profiler.arena;
+  uint64_t bytes = sizeof(ProfileThread) + profiler.eventsPerThread * sizeof(ProfileEvent) + 2 * CACHE_LINE_SIZE;
+  if (!thread && profiler.threadCount < Profiler::maxThreads && arena.capacity - arena.used >= bytes) {
+    thread = new (arena.alloc_raw<ProfileThread>()) ProfileThread{};
+    thread->events = (ProfileEvent*)arena.alloc_aligned(profiler.eventsPerThread * sizeof(ProfileEvent), CACHE_LINE_SIZE);
+    thread->mask = profiler.eventsPerThread - 1;
+    thread->osThreadId = osThreadId;
+    profiler.threads[profiler.threadCount++] = thread;
+  }
+
+  profiler.registering.store(false, std::memory_order_release);
+  if (!thread) LOG_WARN("Profiler is out of thread slots, thread %u isn't recorded", osThreadId);
+  return thread;
+}
+
+uint16_t profile_register(Profiler& profiler, ProfileSite& site) {
+  while (profiler.registering.exchange(true, std::memory_order_acquire)) std::this_thread::yield();
+
+  // Sites from a reloaded library look their names up again instead of adding duplicates
+  uint32_t key = site.key.load(std::memory_order_relaxed);
+  uint16_t id = (key >> 16) == profiler.serial ? (uint16_t)key : 0;
+  for (uint32_t i = 1; i <= profiler.nameCount && !id; i++) {
+    if (strncmp(profiler.names[i], site.name, Profiler::nameSize - 1) == 0) id = (uint16_t)i;
+  }
+  if (!id && profiler.nameCount + 1 < Profiler::maxNames) {
+    id = (uint16_t)++profiler.nameCount;
+    snprintf(profiler.names[id], Profiler::nameSize, "%s", site.name);
+  }
+  if (id) site.key.store(((uint32_t)profiler.serial << 16) | id, std::memory_order_relaxed);
+
+  profiler.registering.store(false, std::memory_order_release);
+  return id;
+}
+
+// Threads may keep recording while this runs, events a writer lapped during the copy are dropped
+bool profiler_write_chrome(Profiler& profiler, const char* path) {
+  FILE* out = fopen(path, "wb");
+  if (!out) {
+    LOG_ERROR("Failed opening profile file: %s", path);
+    return false;
+  }
+
+  uint64_t ns = trace_steady_ns() - profiler.startNs;
+  uint64_t ticks = read_cycle_counter() - profiler.startTsc;
+  double ticksPerNs = ns > 1000000 ? (double)ticks / (double)ns : benchmark_ticks_per_ns(); // Too short a span to calibrate against
+  auto to_us = [&](uint64_t tsc) { return (double)(int64_t)(tsc - profiler.startTsc) / ticksPerNs / 1000.0; };
+
+  while (profiler.registering.exchange(true, std::memory_order_acquire)) std::this_thread::yield();
+  uint32_t threadCount = profiler.threadCount;
+  profiler.registering.store(false, std::memory_order_release);
+
+  bool first = true;
+  fprintf(out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+  for (uint32_t t = 0; t < threadCount; t++) {
+    ProfileThread& thread = *profiler.threads[t];
+    uint64_t capacity = thread.mask + 1;
+    uint64_t end = thread.writePos.load(std::memory_order_acquire);
+    for (uint64_t pos = end > capacity ? end - capacity : 0; pos < end; pos++) {
+      ProfileEvent event = thread.events[pos & thread.mask];
+      if (pos + capacity < thread.writePos.load(std::memory_order_acquire)) continue; // Overwritten while copying
+
+      const char* name = event.name && event.name <= profiler.nameCount ? profiler.names[event.name] : "?";
+      fprintf(out, "%s{\"name\":", first ? "" : ",\n");
+      first = false;
+      if (event.type == ProfileEventType::Zone) {
+        trace_write_json_string(out, name);
+        fprintf(out, ",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"depth\":%u}}",
+                thread.osThreadId, to_us(event.start), (double)event.duration / ticksPerNs / 1000.0, event.depth);
+      } else if (event.type == ProfileEventType::Counter) {
+        trace_write_json_string(out, name);
+        fprintf(out, ",\"ph\":\"C\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"args\":{\"value\":%.17g}}",
+                thread.osThreadId, to_us(event.start), event.value);
+      } else {
+        fprintf(out, "\"frame\",\"ph\":\"i\",\"s\":\"g\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"args\":{\"frame\":%llu}}",
+                thread.osThreadId, to_us(event.start), (unsigned long long)event.frame);
+      }
+    }
+  }
+  fprintf(out, "\n]}\n");
+
+  bool ok = !ferror(out);
+  fclose(out);
+  if (!ok) LOG_ERROR("Failed writing profile file: %s", path);
+  return ok;
+}
+
+// NOTE: Virtual memory
+#ifdef _WIN32
+uint64_t vm_page_size() {
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  return info.dwAllocationGranularity;
+}
+
+void* vm_reserve(uint64_t size) {
+  return VirtualAlloc(nullptr, size, MEM_RESERVE, PAGE_NOACCESS);
+}
+
+bool vm_commit(void* ptr, uint64_t size) {
+  return VirtualAlloc(ptr, size, MEM_COMMIT, PAGE_READWRITE) != nullptr;
+}
+
+void vm_decommit(void* ptr, uint64_t size) {
+  if (size) VirtualFree(ptr, size, MEM_DECOMMIT);
+}
+
+void vm_release(void* ptr, uint64_t size) {
+  VirtualFree(ptr, 0, MEM_RELEASE);
+}
+#else
+uint64_t vm_page_size() {
+  return (uint64_t)sysconf(_SC_PAGESIZE);
+}
+
+void* vm_reserve(uint64_t size) {
+  void* ptr = mmap(nullptr, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  return ptr == MAP_FAILED ? nullptr : ptr;
+}
+
+bool vm_commit(void* ptr, uint64_t size) { // Anonymous pages are zero filled by the kernel on first touch
+  return mprotect(ptr, size, PROT_READ | PROT_WRITE) == 0;
+}
+
+void vm_decommit(void* ptr, uint64_t size) {
+  if (!size) return;
+  madvise(ptr, size, MADV_DONTNEED);
+  mprotect(ptr, size, PROT_NONE);
+}
+
+void vm_release(void* ptr, uint64_t size) {
+  munmap(ptr, size);
+}
+#endif
+
+// NOTE: Arena instrumentation
+void Arena::record_alloc(uint64_t size) {
+  stats->allocations++;
+  if (used > stats->peakUsed) stats->peakUsed = used;
+
+  if (!stats->overBudget && stats->budget > 0.0f && (double)used > (double)capacity * stats->budget) {
+    stats->overBudget = true;
+    LOG_WARN("Arena %s passed %.0f%% of its budget: %llu of %llu bytes", stats->name, stats->budget * 100.0f,
+             (unsigned long long)used, (unsigned long long)capacity);
+  }
+
+  const char* tag = stats->currentTag[0] ? stats->currentTag : "untagged";
+  ArenaTagStats* entry = nullptr;
+  for (uint32_t i = 0; i < stats->tagCount && !entry; i++) {
+    if (strcmp(stats->tags[i].tag, tag) == 0) entry = &stats->tags[i];
+  }
+  if (!entry) {
+    if (stats->tagCount == ArenaStats::maxTags) return;
+    entry = &stats->tags[stats->tagCount++];
+    snprintf(entry->tag, sizeof(entry->tag), "%s", tag);
+    entry->bytes = 0;
+    entry->allocations = 0;
+  }
+  entry->bytes += size;
+  entry->allocations++;
+}
+
+void Arena::record_clear() { // Tag totals describe the current contents, so they reset with them
+  stats->clears++;
+  stats->lastClearTime = (uint64_t)time(nullptr);
+  stats->overBudget = false;
+  stats->tagCount = 0;
+}
+
+void print_arena_stats(const Arena& arena, FILE* file) {
+  const ArenaStats* stats = arena.stats;
+  if (!stats) {
+    fprintf(file, "Arena (not instrumented): %llu / %llu bytes\n", (unsigned long long)arena.used, (unsigned long long)arena.capacity);
+    return;
+  }
+  fprintf(file, "Arena %s: %llu / %llu bytes, peak %llu (%.1f%%), committed %llu, %llu allocations, %llu clears, last clear %llu\n",
+          stats->name, (unsigned long long)arena.used, (unsigned long long)arena.capacity, (unsigned long long)stats->peakUsed,
+          100.0 * (double)stats->peakUsed / (double)arena.capacity, (unsigned long long)arena.committed,
+          (unsigned long long)stats->allocations, (unsigned long long)stats->clears, (unsigned long long)stats->lastClearTime);
+  for (uint32_t i = 0; i < stats->tagCount; i++) {
+    const ArenaTagStats& tag = stats->tags[i];
+    fprintf(file, "  %-16s %12llu bytes %8u allocations\n", tag.tag, (unsigned long long)tag.bytes, tag.allocations);
+  }
+}
+
+bool write_arena_stats(const char* filePath, const Arena* const* arenas, uint32_t count) {
+  FILE* file = fopen(filePath, "w");
+  if (!file) {
+    LOG_ERROR("Failed opening File: %s", filePath);
+    return false;
+  }
+  for (uint32_t i = 0; i < count; i++) print_arena_stats(*arenas[i], file);
+  fclose(file);
+  return true;
+}
+
+// NOTE: Pool
+void SlabAllocator::refill(uint32_t sizeClass) {
+  uint64_t blockSize = class_size(sizeClass);
+  char* slab = (char*)arena->alloc_aligned(slabSize, CACHE_LINE_SIZE);
+  FreeBlock* head = freeLists[sizeClass];
+  for (uint64_t offset = slabSize; offset >= blockSize; offset -= blockSize) { // Lowest address ends up first
+    FreeBlock* block = (FreeBlock*)(slab + offset - blockSize);
+    block->next = head;
+    head = block;
+  }
+  freeLists[sizeClass] = head;
+  classStats[sizeClass].slabs++;
+}
 
 // NOTE: File I/O
 uint64_t get_timestamp(const char* filePath) {
@@ -22,30 +787,34 @@ bool file_exists(const char* filePath) {
   return true;
 }
 
-uint32_t get_file_size(const char* filePath) {
+uint64_t get_file_size(const char* filePath) {
   LOG_ASSERT(filePath, "No filePath supplied!");
 
-  uint32_t fileSize = 0;
-  auto file = fopen(filePath, "rb");
-  if (!file) {
+#ifdef _WIN32
+  struct _stat64 file_stat = {};
+  if (_stat64(filePath, &file_stat) != 0) {
+#else
+  struct stat file_stat = {};
+  if (stat(filePath, &file_stat) != 0) {
+#endif
     LOG_ERROR("Failed opening File: %s", filePath);
     return 0;
   }
 
-  fseek(file, 0, SEEK_END);
-  fileSize = ftell(file);
-  fseek(file, 0, SEEK_SET);
-  fclose(file);
-
-  return fileSize;
+  return (uint64_t)file_stat.st_size;
 }
 
 char* read_file(const char* filePath, Arena& arena) {
   LOG_ASSERT(filePath, "No filePath supplied!");
-  uint32_t fileSize = get_file_size(filePath);
+  uint64_t fileSize = get_file_size(filePath);
 
   char* buffer = arena.alloc_raw<char>(fileSize + 1);
+  buffer[fileSize] = 0;
   auto file = fopen(filePath, "rb");
+  if (!file) {
+    buffer[0] = 0;
+    return buffer;
+  }
   fread(buffer, sizeof(char), fileSize, file);
   fclose(file);
 
@@ -65,8 +834,9 @@ void write_file(const char* filePath, const char* buffer, uint32_t size) {
   fclose(file);
 }
 
-bool copy_file(const char* filePath, const char* outputPath, Arena& arena) {
-  char* data = read_file(filePath, arena);
+bool copy_file(const char* filePath, const char* outputPath) {
+  FileViewScope input(filePath, FileAdvice::Sequential);
+  if (!input.mapped) return false;
 
   auto outputFile = fopen(outputPath, "wb");
   if (!outputFile) {
@@ -74,14 +844,13 @@ bool copy_file(const char* filePath, const char* outputPath, Arena& arena) {
     return false;
   }
 
-  uint32_t fileSize = get_file_size(filePath);
-  uint32_t result = fwrite(data, sizeof(char), fileSize, outputFile);
-  if (!result) {
-    LOG_ERROR("Failed opening File: %s", outputPath);
+  uint64_t result = fwrite(input.view.data, sizeof(char), input.view.size, outputFile);
+  fclose(outputFile);
+  if (result != input.view.size) {
+    LOG_ERROR("Failed writing File: %s", outputPath);
     return false;
   }
 
-  fclose(outputFile);
   return true;
 }
 
@@ -95,6 +864,433 @@ void rename_file(const char *__old, const char *__new) {
   rename(__old, __new);
 }
 
+bool map_file(const char* filePath, FileView& view, FileAdvice advice) {
+  LOG_ASSERT(filePath, "No filePath supplied!");
+  view = FileView{};
+
+#ifdef _WIN32
+  HANDLE file = CreateFileA(filePath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    LOG_ERROR("Failed opening File: %s", filePath);
+    return false;
+  }
+  LARGE_INTEGER size = {};
+  GetFileSizeEx(file, &size);
+  view.size = (uint64_t)size.QuadPart;
+  if (!view.size) { // Empty files can't be mapped
+    CloseHandle(file);
+    view.data = "";
+    return true;
+  }
+  HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  CloseHandle(file);
+  view.data = mapping ? (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+  if (!view.data) {
+    if (mapping) CloseHandle(mapping);
+    view = FileView{};
+    LOG_ERROR("Failed mapping File: %s", filePath);
+    return false;
+  }
+  view.mapping = mapping;
+#else
+  int file = open(filePath, O_RDONLY);
+  if (file < 0) {
+    LOG_ERROR("Failed opening File: %s", filePath);
+    return false;
+  }
+  struct stat file_stat = {};
+  fstat(file, &file_stat);
+  view.size = (uint64_t)file_stat.st_size;
+  if (!view.size) { // Empty files can't be mapped
+    close(file);
+    view.data = "";
+    return true;
+  }
+  void* mapped = mmap(nullptr, view.size, PROT_READ, MAP_PRIVATE, file, 0);
+  close(file); // The mapping keeps the file alive
+  if (mapped == MAP_FAILED) {
+    view = FileView{};
+    LOG_ERROR("Failed mapping File: %s", filePath);
+    return false;
+  }
+  view.data = (const char*)mapped;
+#endif
+
+  if (advice != FileAdvice::Normal) advise_file(view, advice);
+  return true;
+}
+
+void advise_file(const FileView& view, FileAdvice advice) {
+#ifndef _WIN32
+  if (!view.size) return;
+  int hint = advice == FileAdvice::Sequential ? MADV_SEQUENTIAL :
+             advice == FileAdvice::Random ? MADV_RANDOM :
+             advice == FileAdvice::WillNeed ? MADV_WILLNEED : MADV_NORMAL;
+  madvise((void*)view.data, view.size, hint);
+#endif
+}
+
+void unmap_file(FileView& view) {
+  if (view.size) {
+#ifdef _WIN32
+    UnmapViewOfFile(view.data);
+    CloseHandle((HANDLE)view.mapping);
+#else
+    munmap((void*)view.data, view.size);
+#endif
+  }
+  view = FileView{};
+}
+
+// NOTE: Async file I/O
+#ifdef __linux__
+struct IoUring {
+  int fd = -1;
+  uint32_t entries;
+  uint32_t* sqHead;
+  uint32_t* sqTail;
+  uint32_t* sqMask;
+  uint32_t* sqArray;
+  io_uring_sqe* sqes;
+  uint32_t* cqHead;
+  uint32_t* cqTail;
+  uint32_t* cqMask;
+  io_uring_cqe* cqes;
+  void* sqRing;
+  void* cqRing;
+  uint64_t sqRingSize;
+  uint64_t cqRingSize;
+  uint64_t sqesSize;
+  uint32_t unsubmitted; // Queued entries io_uring_enter hasn't been told about
+};
+#endif
+
+struct AsyncIo {
+  static constexpr uint32_t maxWorkers = 16;
+  IoBackend backend;
+  uint32_t queueDepth;
+  uint32_t inFlight = 0; // Submitted & not handed back yet, owning thread only
+  Arena arena{1024 * 1024};
+  MPMCQueueRT<IoRequest*>* pending; // Waiting for a worker
+  MPMCQueueRT<IoRequest*>* finished; // Waiting to be handed back
+  std::mutex mutex; // Guards the counters the threads sleep on
+  std::condition_variable wake; // Workers sleep on queued
+  std::condition_variable done; // The owning thread sleeps on finishedCount
+  uint32_t queued = 0;
+  uint64_t finishedCount = 0;
+  uint64_t finishedSeen = 0; // Owning thread only
+  bool running = true;
+  std::thread workers[maxWorkers];
+  uint32_t workerCount = 0;
+#ifdef __linux__
+  IoUring ring;
+#endif
+};
+
+static int io_open(const IoRequest& request) {
+  int flags = request.op == IoOp::Read ? O_RDONLY : O_WRONLY | O_CREAT;
+#ifdef _WIN32
+  return _open(request.path, flags | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+  return open(request.path, flags | O_CLOEXEC, 0644);
+#endif
+}
+
+static void io_close(int fd) {
+#ifdef _WIN32
+  _close(fd);
+#else
+  close(fd);
+#endif
+}
+
+// Blocking transfer of the whole request, short only at end of file
+static int64_t io_transfer(int fd, const IoRequest& request) {
+  uint64_t transferred = 0;
+  while (transferred < request.size) {
+    char* buffer = request.buffer + transferred;
+    uint64_t offset = request.offset + transferred;
+    uint64_t chunk = std::min<uint64_t>(request.size - transferred, 1ull << 30);
+#ifdef _WIN32
+    OVERLAPPED overlapped = {};
+    overlapped.Offset = (DWORD)offset;
+    overlapped.OffsetHigh = (DWORD)(offset >> 32);
+    DWORD moved = 0;
+    HANDLE file = (HANDLE)_get_osfhandle(fd);
+    BOOL ok = request.op == IoOp::Read ? ReadFile(file, buffer, (DWORD)chunk, &moved, &overlapped) : WriteFile(file, buffer, (DWORD)chunk, &moved, &overlapped);
+    if (!ok && GetLastError() != ERROR_HANDLE_EOF) return -(int64_t)GetLastError();
+    int64_t result = (int64_t)moved;
+#else
+    int64_t result = request.op == IoOp::Read ? pread(fd, buffer, chunk, (off_t)offset) : pwrite(fd, buffer, chunk, (off_t)offset);
+    if (result < 0 && errno == EINTR) continue;
+    if (result < 0) return -(int64_t)errno;
+#endif
+    if (result == 0) break;
+    transferred += (uint64_t)result;
+  }
+  return (int64_t)transferred;
+}
+
+static void io_worker(AsyncIo& io) {
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(io.mutex);
+      io.wake.wait(lock, [&]() { return io.queued > 0 || !io.running; });
+      if (!io.queued) return; // Stopped & drained
+      io.queued--;
+    }
+    IoRequest* request = io.pending->pop(); // Pushed before queued was raised
+
+    int fd = request->openedFd >= 0 ? request->openedFd : request->fd;
+    request->result = io_transfer(fd, *request);
+    io.finished->push(request);
+    {
+      std::lock_guard<std::mutex> lock(io.mutex);
+      io.finishedCount++;
+    }
+    io.done.notify_one();
+  }
+}
+
+#ifdef __linux__
+static bool uring_create(IoUring& ring, uint32_t entries) {
+  io_uring_params params = {};
+  int fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+  if (fd < 0) return false;
+  if (!(params.features & IORING_FEAT_RW_CUR_POS)) { // Stands in for IORING_OP_READ/WRITE, both arrived in 5.6
+    close(fd);
+    return false;
+  }
+
+  ring.sqRingSize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+  ring.cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+  if (single) ring.sqRingSize = ring.cqRingSize = std::max(ring.sqRingSize, ring.cqRingSize);
+  ring.sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+
+  void* sq = mmap(nullptr, ring.sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+  void* cq = single ? sq : mmap(nullptr, ring.cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+  void* sqes = mmap(nullptr, ring.sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+  if (sq == MAP_FAILED || cq == MAP_FAILED || sqes == MAP_FAILED) {
+    if (sq != MAP_FAILED) munmap(sq, ring.sqRingSize);
+    if (!single && cq != MAP_FAILED) munmap(cq, ring.cqRingSize);
+    if (sqes != MAP_FAILED) munmap(sqes, ring.sqesSize);
+    close(fd);
+    return false;
+  }
+
+  ring.fd = fd;
+  ring.entries = params.sq_entries;
+  ring.sqRing = sq;
+  ring.cqRing = cq;
+  ring.sqHead = (uint32_t*)((char*)sq + params.sq_off.head);
+  ring.sqTail = (uint32_t*)((char*)sq + params.sq_off.tail);
+  ring.sqMask = (uint32_t*)((char*)sq + params.sq_off.ring_mask);
+  ring.sqArray = (uint32_t*)((char*)sq + params.sq_off.array);
+  ring.sqes = (io_uring_sqe*)sqes;
+  ring.cqHead = (uint32_t*)((char*)cq + params.cq_off.head);
+  ring.cqTail = (uint32_t*)((char*)cq + params.cq_off.tail);
+  ring.cqMask = (uint32_t*)((char*)cq + params.cq_off.ring_mask);
+  ring.cqes = (io_uring_cqe*)((char*)cq + params.cq_off.cqes);
+  ring.unsubmitted = 0;
+  return true;
+}
+
+static void uring_destroy(IoUring& ring) {
+  if (ring.fd < 0) return;
+  munmap(ring.sqes, ring.sqesSize);
+  if (ring.cqRing != ring.sqRing) munmap(ring.cqRing, ring.cqRingSize);
+  munmap(ring.sqRing, ring.sqRingSize);
+  close(ring.fd);
+  ring.fd = -1;
+}
+
+// Queues the rest of the request, a resumed short transfer picks up where it stopped
+static void uring_queue(IoUring& ring, IoRequest& request) {
+  uint32_t tail = *ring.sqTail; // Only we write the tail
+  uint32_t idx = tail & *ring.sqMask;
+  io_uring_sqe& sqe = ring.sqes[idx];
+  memset(&sqe, 0, sizeof(sqe));
+  sqe.opcode = request.op == IoOp::Read ? IORING_OP_READ : IORING_OP_WRITE;
+  sqe.fd = request.openedFd >= 0 ? request.openedFd : request.fd;
+  sqe.off = request.offset + request.transferred;
+  sqe.addr = (uint64_t)(uintptr_t)(request.buffer + request.transferred);
+  sqe.len = (uint32_t)std::min<uint64_t>(request.size - request.transferred, 1ull << 30);
+  sqe.user_data = (uint64_t)(uintptr_t)&request;
+  ring.sqArray[idx] = idx;
+  __atomic_store_n(ring.sqTail, tail + 1, __ATOMIC_RELEASE);
+  ring.unsubmitted++;
+}
+
+static void uring_enter(IoUring& ring, uint32_t minComplete) {
+  uint32_t flags = minComplete ? IORING_ENTER_GETEVENTS : 0;
+  while (ring.unsubmitted || minComplete) {
+    int submitted = (int)syscall(__NR_io_uring_enter, ring.fd, ring.unsubmitted, minComplete, flags, nullptr, 0);
+    if (submitted < 0) {
+      if (errno == EINTR || errno == EAGAIN || errno == EBUSY) continue;
+      LOG_ERROR("io_uring_enter failed: %d", errno);
+      return;
+    }
+    ring.unsubmitted -= std::min<uint32_t>((uint32_t)submitted, ring.unsubmitted);
+    minComplete = 0; // The call only returns once they completed
+  }
+}
+#endif
+
+// Runs on the owning thread
+static void io_hand_back(AsyncIo& io, IoRequest& request) {
+  if (request.openedFd >= 0) {
+    io_close(request.openedFd);
+    request.openedFd = -1;
+  }
+  io.inFlight--;
+  request.status.store(request.result < 0 ? IoStatus::Failed : IoStatus::Done, std::memory_order_release);
+  if (request.callback) request.callback(request); // May submit more or release the request
+}
+
+static void io_block(AsyncIo& io) {
+#ifdef __linux__
+  if (io.backend == IoBackend::Uring) {
+    uring_enter(io.ring, 1);
+    return;
+  }
+#endif
+  std::unique_lock<std::mutex> lock(io.mutex);
+  io.done.wait(lock, [&]() { return io.finishedCount != io.finishedSeen; });
+  io.finishedSeen = io.finishedCount;
+}
+
+AsyncIo* async_io_create(uint32_t queueDepth, uint32_t workerCount, IoBackend preferred) {
+  LOG_ASSERT(queueDepth > 0, "Async IO needs a queue depth!");
+  AsyncIo* io = new AsyncIo{};
+  io->queueDepth = queueDepth;
+  io->pending = &io->arena.create_mpmc_queue_rt<IoRequest*>(queueDepth);
+  io->finished = &io->arena.create_mpmc_queue_rt<IoRequest*>(queueDepth);
+  io->backend = IoBackend::Workers;
+#ifdef __linux__
+  if (preferred == IoBackend::Uring && uring_create(io->ring, queueDepth)) io->backend = IoBackend::Uring;
+#endif
+
+  if (io->backend == IoBackend::Workers) {
+    io->workerCount = std::max<uint32_t>(1, std::min(workerCount, AsyncIo::maxWorkers));
+    for (uint32_t i = 0; i < io->workerCount; i++) io->workers[i] = std::thread(io_worker, std::ref(*io));
+  }
+  return io;
+}
+
+void async_io_destroy(AsyncIo* io) {
+  if (!io) return;
+  async_io_wait_all(*io);
+  {
+    std::lock_guard<std::mutex> lock(io->mutex);
+    io->running = false;
+  }
+  io->wake.notify_all();
+  for (uint32_t i = 0; i < io->workerCount; i++) io->workers[i].join();
+#ifdef __linux__
+  uring_destroy(io->ring);
+#endif
+  delete io;
+}
+
+IoBackend async_io_backend(const AsyncIo& io) {
+  return io.backend;
+}
+
+void async_io_submit(AsyncIo& io, IoRequest* requests, uint32_t count) {
+  for (uint32_t i = 0; i < count; i++) {
+    IoRequest& request = requests[i];
+    LOG_ASSERT(request.status.load(std::memory_order_relaxed) != IoStatus::Pending, "IO request submitted twice!");
+    while (io.inFlight >= io.queueDepth) {
+      if (!async_io_poll(io)) io_block(io);
+    }
+
+    request.result = 0;
+    request.transferred = 0;
+    request.openedFd = -1;
+    request.status.store(IoStatus::Pending, std::memory_order_relaxed);
+    io.inFlight++;
+
+    if (request.path) { // Opening stays on this thread, only the transfer is asynchronous
+      request.openedFd = io_open(request);
+      if (request.openedFd < 0) {
+        request.result = -(int64_t)errno;
+        io.finished->push(&request); // Handed back by the next poll like any other completion
+        continue;
+      }
+    }
+
+#ifdef __linux__
+    if (io.backend == IoBackend::Uring) {
+      if (request.size) uring_queue(io.ring, request);
+      else io.finished->push(&request);
+      continue;
+    }
+#endif
+    io.pending->push(&request);
+    {
+      std::lock_guard<std::mutex> lock(io.mutex);
+      io.queued++;
+    }
+    io.wake.notify_one();
+  }
+
+#ifdef __linux__
+  if (io.backend == IoBackend::Uring) uring_enter(io.ring, 0); // The whole batch in one syscall
+#endif
+}
+
+uint32_t async_io_poll(AsyncIo& io) {
+  uint32_t handed = 0;
+
+#ifdef __linux__
+  if (io.backend == IoBackend::Uring) {
+    IoUring& ring = io.ring;
+    uint32_t head = *ring.cqHead;
+    uint32_t tail = __atomic_load_n(ring.cqTail, __ATOMIC_ACQUIRE);
+    while (head != tail) {
+      io_uring_cqe& cqe = ring.cqes[head & *ring.cqMask];
+      IoRequest& request = *(IoRequest*)(uintptr_t)cqe.user_data;
+      int32_t result = cqe.res;
+      __atomic_store_n(ring.cqHead, ++head, __ATOMIC_RELEASE);
+      if (result < 0) {
+        request.result = result;
+      } else {
+        request.transferred += (uint64_t)result;
+        if (result > 0 && request.transferred < request.size) { // Short transfer, resume it
+          uring_queue(ring, request);
+          continue;
+        }
+        request.result = (int64_t)request.transferred;
+      }
+      io_hand_back(io, request);
+      handed++;
+      tail = __atomic_load_n(ring.cqTail, __ATOMIC_ACQUIRE);
+    }
+    uring_enter(ring, 0);
+  }
+#endif
+
+  IoRequest* request;
+  while (io.finished->try_pop(request)) {
+    io_hand_back(io, *request);
+    handed++;
+  }
+  return handed;
+}
+
+void async_io_wait(AsyncIo& io, IoRequest& request) {
+  while (request.status.load(std::memory_order_acquire) == IoStatus::Pending) {
+    if (!async_io_poll(io)) io_block(io);
+  }
+}
+
+void async_io_wait_all(AsyncIo& io) {
+  while (io.inFlight) {
+    if (!async_io_poll(io)) io_block(io);
+  }
+}
+
 // NOTE: Testing
 bool CompareFloat(float a, float b, float epsilon) {
   return fabs(a - b) <= epsilon;
@@ -140,6 +1336,232 @@ bool CompareUShortArrays(const unsigned short* a, const unsigned short* b, uint3
   return memcmp(a, b, size) == 0;
 }
 
+// NOTE: Benchmarking
+const char* PerfCounterNames[PERF_COUNTER_COUNT] = {
+  "cycles",
+  "instructions",
+  "l1d_misses",
+  "llc_misses",
+  "branch_misses",
+  "dtlb_misses",
+};
+
+#ifdef __linux__
+bool PerfCounters::open() {
+  close();
+  struct Event {
+    uint32_t type;
+    uint64_t config;
+  };
+  auto cache_miss = [](uint64_t cache) {
+    return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+  };
+  const Event events[PERF_COUNTER_COUNT] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_L1D)},
+    {PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_LL)},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    {PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_DTLB)},
+  };
+
+  for (uint32_t i = 0; i < PERF_COUNTER_COUNT; i++) {
+    perf_event_attr attr = {};
+    attr.size = sizeof(attr);
+    attr.type = events[i].type;
+    attr.config = events[i].config;
+    attr.exclude_kernel = 1; // Allowed with the default perf_event_paranoid
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    fds[i] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    if (fds[i] >= 0) mask |= 1u << i;
+  }
+  return mask != 0;
+}
+
+void PerfCounters::close() {
+  for (int& fd : fds) {
+    if (fd >= 0) ::close(fd);
+    fd = -1;
+  }
+  mask = 0;
+}
+
+void PerfCounters::read(uint64_t* values) const {
+  for (uint32_t i = 0; i < PERF_COUNTER_COUNT; i++) {
+    values[i] = 0;
+    uint64_t data[3]; // value, time enabled, time running
+    if (fds[i] < 0 || ::read(fds[i], data, sizeof(data)) != (ssize_t)sizeof(data)) continue;
+    values[i] = data[2] && data[2] < data[1] ? (uint64_t)((double)data[0] * (double)data[1] / (double)data[2]) : data[0];
+  }
+}
+#else
+bool PerfCounters::open() {
+  return false;
+}
+
+void PerfCounters::close() {
+  mask = 0;
+}
+
+void PerfCounters::read(uint64_t* values) const {
+  for (uint32_t i = 0; i < PERF_COUNTER_COUNT; i++) values[i] = 0;
+}
+#endif
+
+double benchmark_ticks_per_ns() {
+  static double ticksPerNs = []() {
+    auto start = std::chrono::steady_clock::now();
+    uint64_t startTicks = read_cycle_counter();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    uint64_t ticks = read_cycle_counter() - startTicks;
+    double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    return ticks && ns > 0.0 ? (double)ticks / ns : 1.0;
+  }();
+  return ticksPerNs;
+}
+
+void benchmark_stats(double* samplesNs, uint32_t count, BenchmarkResult& result) {
+  result.samples = count;
+  if (!count) return;
+  SortLess less;
+  SortIdentity identity;
+  PdqSort::sort(samplesNs, samplesNs + count, less, identity);
+
+  double sum = 0.0;
+  for (uint32_t i = 0; i < count; i++) sum += samplesNs[i];
+  double mean = sum / count;
+  double squares = 0.0;
+  for (uint32_t i = 0; i < count; i++) squares += (samplesNs[i] - mean) * (samplesNs[i] - mean);
+
+  uint32_t p99Rank = (uint32_t)ceil(0.99 * count); // Nearest rank
+  result.minNs = samplesNs[0];
+  result.medianNs = count % 2 ? samplesNs[count / 2] : (samplesNs[count / 2 - 1] + samplesNs[count / 2]) * 0.5;
+  result.p99Ns = samplesNs[(p99Rank ? p99Rank : 1) - 1];
+  result.meanNs = mean;
+  result.stddevNs = count > 1 ? sqrt(squares / (count - 1)) : 0.0;
+}
+
+const BenchmarkResult* BenchmarkSuite::finish(const char* name, uint64_t param, uint64_t iterations, uint32_t count) {
+  LOG_ASSERT(!strchr(name, ','), "Benchmark names can't contain commas: %s", name);
+  BenchmarkResult& result = results.elements[results.add(BenchmarkResult{})];
+  snprintf(result.name, sizeof(result.name), "%s", name);
+  result.param = param;
+  result.iterations = iterations;
+  benchmark_stats(samplesNs, count, result);
+  result.counterMask = countersEnabled ? perf.mask : 0;
+  for (uint32_t c = 0; c < PERF_COUNTER_COUNT; c++) {
+    result.counters[c] = count ? (double)counterTotals[c] / ((double)count * (double)iterations) : 0.0;
+  }
+
+  char label[96];
+  if (param) snprintf(label, sizeof(label), "%s/%llu", result.name, (unsigned long long)param);
+  else snprintf(label, sizeof(label), "%s", result.name);
+  printf("  %-44s median %12.1f ns  min %12.1f  p99 %12.1f  stddev %5.1f%%  (%u x %llu)\n", label, result.medianNs,
+         result.minNs, result.p99Ns, result.meanNs > 0.0 ? result.stddevNs / result.meanNs * 100.0 : 0.0, result.samples,
+         (unsigned long long)result.iterations);
+  // Per item numbers make different sizes comparable
+  double items = config.paramIsItems && param ? (double)param : 1.0;
+  if (items > 1.0 || result.counterMask) {
+    printf("  %-44s", "");
+    if (items > 1.0) printf(" %.2f ns/item", result.medianNs / items);
+    for (uint32_t c = 0; c < PERF_COUNTER_COUNT; c++) {
+      if (result.counterMask & (1u << c)) printf(" %s %.2f", PerfCounterNames[c], result.counters[c] / items);
+    }
+    uint32_t ipcMask = (1u << PERF_CYCLES) | (1u << PERF_INSTRUCTIONS);
+    if ((result.counterMask & ipcMask) == ipcMask && result.counters[PERF_CYCLES] > 0.0) {
+      printf(" ipc %.2f", result.counters[PERF_INSTRUCTIONS] / result.counters[PERF_CYCLES]);
+    }
+    printf("\n");
+  }
+  return &result;
+}
+
+bool BenchmarkSuite::write_json(const char* path) const {
+  FILE* file = fopen(path, "wb");
+  if (!file) {
+    LOG_ERROR("Failed opening File: %s", path);
+    return false;
+  }
+
+  fprintf(file, "{\n  \"benchmarks\": [\n");
+  for (uint32_t i = 0; i < results.count; i++) {
+    const BenchmarkResult& r = results.elements[i];
+    fprintf(file, "    {\"name\": \"%s\", \"param\": %llu, \"iterations\": %llu, \"samples\": %u, \"min_ns\": %.3f, \"median_ns\": %.3f, "
+            "\"p99_ns\": %.3f, \"mean_ns\": %.3f, \"stddev_ns\": %.3f", r.name, (unsigned long long)r.param,
+            (unsigned long long)r.iterations, r.samples, r.minNs, r.medianNs, r.p99Ns, r.meanNs, r.stddevNs);
+    for (uint32_t c = 0; c < PERF_COUNTER_COUNT; c++) { // Per iteration, only the ones measured
+      if (r.counterMask & (1u << c)) fprintf(file, ", \"%s\": %.3f", PerfCounterNames[c], r.counters[c]);
+    }
+    fprintf(file, "}%s\n", i + 1 < results.count ? "," : "");
+  }
+  fprintf(file, "  ]\n}\n");
+  fclose(file);
+  return true;
+}
+
+bool BenchmarkSuite::write_csv(const char* path) const {
+  FILE* file = fopen(path, "wb");
+  if (!file) {
+    LOG_ERROR("Failed opening File: %s", path);
+    return false;
+  }
+
+  fprintf(file, "name,param,iterations,samples,min_ns,median_ns,p99_ns,mean_ns,stddev_ns");
+  for (uint32_t c = 0; c < PERF_COUNTER_COUNT; c++) fprintf(file, ",%s", PerfCounterNames[c]);
+  fprintf(file, "\n");
+  for (uint32_t i = 0; i < results.count; i++) {
+    const BenchmarkResult& r = results.elements[i];
+    fprintf(file, "%s,%llu,%llu,%u,%.3f,%.3f,%.3f,%.3f,%.3f", r.name, (unsigned long long)r.param,
+            (unsigned long long)r.iterations, r.samples, r.minNs, r.medianNs, r.p99Ns, r.meanNs, r.stddevNs);
+    for (uint32_t c = 0; c < PERF_COUNTER_COUNT; c++) { // Empty when not measured
+      if (r.counterMask & (1u << c)) fprintf(file, ",%.3f", r.counters[c]);
+      else fprintf(file, ",");
+    }
+    fprintf(file, "\n");
+  }
+  fclose(file);
+  return true;
+}
+
+uint32_t BenchmarkSuite::compare_baseline(const char* path, double threshold) const {
+  if (!file_exists(path)) {
+    LOG_WARN("No benchmark baseline at %s", path);
+    return 0;
+  }
+  Arena scratch(get_file_size(path) + KB(4));
+  char* data = read_file(path, scratch);
+  data[get_file_size(path)] = 0;
+
+  uint32_t regressions = 0;
+  printf("\n=== Baseline comparison (%s, threshold %.0f%%) ===\n", path, threshold * 100.0);
+  for (uint32_t i = 0; i < results.count; i++) {
+    const BenchmarkResult& r = results.elements[i];
+    double baseline = 0.0;
+    for (char* line = strchr(data, '\n'); line && *line; line = strchr(line, '\n')) { // Skips the header row
+      line++;
+      char name[64];
+      unsigned long long param;
+      double median;
+      if (sscanf(line, "%63[^,],%llu,%*u,%*u,%*f,%lf", name, &param, &median) == 3 && param == r.param && strcmp(name, r.name) == 0) {
+        baseline = median;
+        break;
+      }
+    }
+
+    if (baseline <= 0.0) {
+      printf("  %-44s new\n", r.name);
+      continue;
+    }
+    double change = r.medianNs / baseline - 1.0;
+    bool regressed = change > threshold;
+    regressions += regressed;
+    printf("  %-36s %8llu %12.1f ns vs %12.1f ns %+7.1f%% %s\n", r.name, (unsigned long long)r.param, r.medianNs, baseline,
+           change * 100.0, regressed ? "REGRESSION" : change < -threshold ? "improved" : "");
+  }
+  return regressions;
+}
+
 // NOTE: Direct std:: replacements
 float Clamp(float value, float min, float max) {
     if (value < min) return min;
@@ -12,38 +12,49 @@
 #include <new>
 #include <cstring>
 #include <typeinfo>
+#include <type_traits>
+#include <utility>
+#include <tuple>
+#include <thread>
+#include <atomic>
+#include <chrono>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+    #include <emmintrin.h> // SSE2 for hashmap group probing
+#endif
+#ifdef __AVX2__
+    #include <immintrin.h> // AVX2 for bulk bitset ops
+#endif
 
 // NOTE: Cross platform stuffs
 #ifdef _WIN32
     #define DEBUG_BREAK() __debugbreak()
     #define EXPORT_FN __declspec(dllexport)
     #include <windows.h>
-    
-    #define BENCHMARK(fn, iterations) do { \
-        FILETIME creationTime, exitTime, kernelTime, userTime; \
-        GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime); \
-        ULARGE_INTEGER start, end; \
-        start.LowPart = userTime.dwLowDateTime; \
-        start.HighPart = userTime.dwHighDateTime; \
-        for (int i = 0; i < iterations; ++i) { fn(); } \
-        GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime); \
-        end.LowPart = userTime.dwLowDateTime; \
-        end.HighPart = userTime.dwHighDateTime; \
-        double elapsed = (end.QuadPart - start.QuadPart) / 10.0; \
-        printf("%.3f µs\n", elapsed / iterations); \
-    } while (0)
 #elif __linux__ || __APPLE__
     #define DEBUG_BREAK() __builtin_trap()
     #define EXPORT_FN extern "C"
     #include <ctime>
-    
-    #define BENCHMARK(fn, iterations) do { \
-        clock_t start = clock(); \
-        for (uint32_t i = 0; i < iterations; ++i) { fn(); } \
-        clock_t end = clock(); \
-        double elapsed = (double)(end - start) / CLOCKS_PER_SEC * 1e6; \
-        printf("%.3f µs\n", elapsed / iterations); \
-    } while (0)
+#endif
+
+#if defined(_MSC_VER)
+    #include <xmmintrin.h>
+    #define PREFETCH(addr) _mm_prefetch((const char*)(addr), _MM_HINT_T0)
+#else
+    #define PREFETCH(addr) __builtin_prefetch(addr)
+#endif
+
+constexpr uint64_t CACHE_LINE_SIZE = 64;
+
+// Raw cycle counter, only meaningful as a difference. Falls back to steady clock nanoseconds
+#if defined(_MSC_VER)
+    #include <intrin.h>
+    inline uint64_t read_cycle_counter() { return __rdtsc(); }
+#elif defined(__x86_64__) || defined(__i386__)
+    #include <x86intrin.h>
+    inline uint64_t read_cycle_counter() { return __rdtsc(); }
+#else
+    inline uint64_t read_cycle_counter() { return (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count(); }
 #endif
 
 // NOTE: Logging
@@ -68,53 +79,485 @@ enum TextColor
   TEXT_COLOR_COUNT
 };
 
-template <typename ...Args>
-void _log(const char* prefix, const char* msg, TextColor textColor, Args... args)
-{
-  const static char* TextColorTable[TEXT_COLOR_COUNT] = 
-  {    
-    "\x1b[30m", // TEXT_COLOR_BLACK
-    "\x1b[31m", // TEXT_COLOR_RED
-    "\x1b[32m", // TEXT_COLOR_GREEN
-    "\x1b[33m", // TEXT_COLOR_YELLOW
-    "\x1b[34m", // TEXT_COLOR_BLUE
-    "\x1b[35m", // TEXT_COLOR_MAGENTA
-    "\x1b[36m", // TEXT_COLOR_CYAN
-    "\x1b[37m", // TEXT_COLOR_WHITE
-    "\x1b[90m", // TEXT_COLOR_BRIGHT_BLACK
-    "\x1b[91m", // TEXT_COLOR_BRIGHT_RED
-    "\x1b[92m", // TEXT_COLOR_BRIGHT_GREEN
-    "\x1b[93m", // TEXT_COLOR_BRIGHT_YELLOW
-    "\x1b[94m", // TEXT_COLOR_BRIGHT_BLUE
-    "\x1b[95m", // TEXT_COLOR_BRIGHT_MAGENTA
-    "\x1b[96m", // TEXT_COLOR_BRIGHT_CYAN
-    "\x1b[97m", // TEXT_COLOR_BRIGHT_WHITE
-  };
+// Log records are built on the calling thread with their arguments copied by value (strings
+// included) & handed to a per thread lock-free queue. A background thread started by
+// log_start() formats & writes them. Without it records are written synchronously.
+#define LOG_LEVEL_TRACE 0
+#define LOG_LEVEL_WARN 1
+#define LOG_LEVEL_ERROR 2
+#define LOG_LEVEL_NONE 3
+#ifndef LOG_LEVEL
+  #define LOG_LEVEL LOG_LEVEL_TRACE // Compile time minimum, lower levels compile to nothing
+#endif
+
+enum class LogLevel : uint8_t { Trace, Warn, Error, None };
+
+// Runtime level per subsystem, e.g. inline LogChannel logNet("net"); LOG_TRACE_TO(logNet, "...");
+struct LogChannel {
+  const char* name;
+  std::atomic<uint8_t> level;
+
+  LogChannel(const char* _name, LogLevel _level = LogLevel::Trace) : name(_name), level((uint8_t)_level) {}
+
+  void set_level(LogLevel _level) { level.store((uint8_t)_level, std::memory_order_relaxed); }
+
+  bool enabled(LogLevel _level) const { return (uint8_t)_level >= level.load(std::memory_order_relaxed); }
+};
+
+inline LogChannel logDefault("");
+
+struct LogRecord {
+  static constexpr uint32_t payloadSize = 224;
+  void (*format)(const LogRecord& record, char* out, size_t size);
+  const char* msg; // Format string, must outlive the record (string literals)
+  const LogChannel* channel;
+  LogLevel level;
+  char payload[payloadSize]; // Encoded arguments
+};
+
+template<typename T>
+struct LogArg {
+  static_assert(std::is_arithmetic_v<T> || std::is_pointer_v<T> || std::is_enum_v<T>, "Log arguments must be printf compatible");
+  static constexpr uint32_t fixedSize = sizeof(T);
+  using Decoded = T;
+
+  static void encode(char*& cursor, const char* end, T value) {
+    memcpy(cursor, &value, sizeof(T));
+    cursor += sizeof(T);
+  }
+
+  static T decode(const char*& cursor) {
+    T value;
+    memcpy(&value, cursor, sizeof(T));
+    cursor += sizeof(T);
+    return value;
+  }
+};
+
+template<>
+struct LogArg<const char*> { // Copied so the caller's buffer may change right after logging
+  static constexpr uint32_t fixedSize = 1;
+  using Decoded = const char*;
+
+  static void encode(char*& cursor, const char* end, const char* value) {
+    if (!value) value = "(null)";
+    const char* last = end - 1; // Truncates to leave room for the arguments after it
+    while (*value && cursor < last) *cursor++ = *value++;
+    *cursor++ = 0;
+  }
+
+  static const char* decode(const char*& cursor) {
+    const char* value = cursor;
+    cursor += strlen(value) + 1;
+    return value;
+  }
+};
+
+template<>
+struct LogArg<char*> : LogArg<const char*> {};
+
+template<typename... Args, size_t... I>
+void log_encode(char* cursor, char* end, std::index_sequence<I...>, Args... args) {
+  static_assert((LogArg<Args>::fixedSize + ... + 0) <= LogRecord::payloadSize, "Too many log arguments");
+  if constexpr (sizeof...(Args) > 0) {
+    constexpr uint32_t sizes[] = {LogArg<Args>::fixedSize...};
+    auto reserved_after = [&](size_t idx) {
+      uint32_t total = 0;
+      for (size_t j = idx + 1; j < sizeof...(Args); j++) total += sizes[j];
+      return total;
+    };
+    (LogArg<Args>::encode(cursor, end - reserved_after(I), args), ...);
+  }
+}
+
+template<typename... Args>
+void log_format(const LogRecord& record, char* out, size_t size) {
+  [[maybe_unused]] const char* cursor = record.payload; // Unused without arguments
+  std::tuple<typename LogArg<Args>::Decoded...> args{LogArg<Args>::decode(cursor)...}; // Braces keep the decode order
+  std::apply([&](auto... values) { snprintf(out, size, record.msg, values...); }, args);
+}
+
+void log_submit(const LogRecord& record); // Queues the record, or writes it when the logger isn't running
+void log_flush(); // Writes everything queued so far before returning
+void log_start();
+void log_stop();
 
-  char formatBuffer[8192] = {};
-  sprintf(formatBuffer, "%s %s %s \033[0m", TextColorTable[textColor], prefix, msg);
+typedef void (*LogSink)(const char* line, LogLevel level, void* user);
+void log_set_sink(LogSink sink, void* user); // nullptr restores stdout
 
-  char textBuffer[8912] = {};
-  sprintf(textBuffer, formatBuffer, args...);
+struct LogScope { // Runs the background logger for the lifetime of the scope
+  LogScope() { log_start(); }
+  ~LogScope() { log_stop(); }
+};
 
-  puts(textBuffer);
+template <typename ...Args>
+void _log(const LogChannel& channel, LogLevel level, const char* msg, Args... args)
+{
+  if (!channel.enabled(level)) return;
+  LogRecord record;
+  record.format = &log_format<Args...>;
+  record.msg = msg;
+  record.channel = &channel;
+  record.level = level;
+  log_encode(record.payload, record.payload + LogRecord::payloadSize, std::index_sequence_for<Args...>{}, args...);
+  log_submit(record);
 }
 
-#define LOG_TRACE(msg, ...) _log("TRACE: ", msg, TEXT_COLOR_GREEN, ##__VA_ARGS__);
-// #define LOG_TRACE(msg, ...) ((void)0); // Uncomment this for performance testing
-#define LOG_WARN(msg, ...) _log("WARN: ", msg, TEXT_COLOR_YELLOW, ##__VA_ARGS__);
-#define LOG_ERROR(msg, ...) _log("ERROR: ", msg, TEXT_COLOR_RED, ##__VA_ARGS__);
+#if LOG_LEVEL <= LOG_LEVEL_TRACE
+  #define LOG_TRACE(msg, ...) _log(logDefault, LogLevel::Trace, msg, ##__VA_ARGS__);
+  #define LOG_TRACE_TO(channel, msg, ...) _log(channel, LogLevel::Trace, msg, ##__VA_ARGS__);
+#else
+  #define LOG_TRACE(msg, ...) ((void)0);
+  #define LOG_TRACE_TO(channel, msg, ...) ((void)0);
+#endif
+#if LOG_LEVEL <= LOG_LEVEL_WARN
+  #define LOG_WARN(msg, ...) _log(logDefault, LogLevel::Warn, msg, ##__VA_ARGS__);
+  #define LOG_WARN_TO(channel, msg, ...) _log(channel, LogLevel::Warn, msg, ##__VA_ARGS__);
+#else
+  #define LOG_WARN(msg, ...) ((void)0);
+  #define LOG_WARN_TO(channel, msg, ...) ((void)0);
+#endif
+#if LOG_LEVEL <= LOG_LEVEL_ERROR
+  #define LOG_ERROR(msg, ...) _log(logDefault, LogLevel::Error, msg, ##__VA_ARGS__);
+  #define LOG_ERROR_TO(channel, msg, ...) _log(channel, LogLevel::Error, msg, ##__VA_ARGS__);
+#else
+  #define LOG_ERROR(msg, ...) ((void)0);
+  #define LOG_ERROR_TO(channel, msg, ...) ((void)0);
+#endif
 
+// Always reports, whatever LOG_LEVEL is, & flushes queued records before breaking
 #define LOG_ASSERT(x, msg, ...)      \
 {                                    \
   if(!(x))                           \
   {                                  \
-    LOG_ERROR(msg, ##__VA_ARGS__);   \
+    _log(logDefault, LogLevel::Error, msg, ##__VA_ARGS__); \
+    log_flush();                     \
     DEBUG_BREAK();                   \
     LOG_ERROR("Assertion HIT!")      \
   }                                  \
 }
 
+// NOTE: Binary trace
+// TRACE records a call site id, a cycle counter timestamp & the raw argument bytes into a
+// memory mapped ring file. Nothing is formatted at runtime, trace_decode turns the file into
+// text or Chrome trace JSON later, the file survives a crash so the last moments can be read back.
+#ifndef TRACE_ENABLED
+  #define TRACE_ENABLED 1
+#endif
+
+struct TraceSite {
+  const char* format;
+  const char* file;
+  uint32_t line;
+  std::atomic<uint32_t> key; // (buffer serial << 16) | site id, 0 until registered with the active buffer
+
+  constexpr TraceSite(const char* _format, const char* _file, uint32_t _line) : format(_format), file(_file), line(_line), key(0) {}
+};
+
+struct TraceRecord { // One cache line per record so writers on different threads never share
+  static constexpr uint32_t payloadSize = 40;
+  std::atomic<uint64_t> seq; // Write position + 1, 0 while being written
+  uint64_t tsc;
+  uint16_t site;
+  uint16_t size;
+  uint32_t thread;
+  char payload[payloadSize];
+};
+static_assert(sizeof(TraceRecord) == CACHE_LINE_SIZE, "Trace records are one cache line");
+
+struct TraceFileHeader;
+
+struct TraceBuffer {
+  TraceFileHeader* header;
+  std::atomic<uint64_t>* writePos; // Lives in the file header
+  std::atomic<bool> registering; // Guards the site table, shared by every module attached to the buffer
+  TraceRecord* records;
+  uint64_t mask; // Record count - 1
+  uint64_t fileSize;
+  uint16_t serial;
+  void* mapping; // Platform handle for the file mapping
+};
+
+inline TraceBuffer* traceActive = nullptr; // Per module, libraries pick the host's buffer up with trace_attach
+inline thread_local uint32_t traceThreadId = 0;
+
+TraceBuffer* trace_open(const char* path, uint32_t recordCount = 1 << 16); // Rounds up to a power of two, becomes active
+void trace_close(TraceBuffer* buffer);
+void trace_attach(TraceBuffer* buffer);
+uint16_t trace_register(TraceBuffer& buffer, TraceSite& site, const char* signature);
+uint32_t trace_os_thread_id();
+bool trace_decode_text(const char* path, FILE* out);
+bool trace_decode_chrome(const char* path, FILE* out);
+
+struct TraceScope {
+  TraceBuffer* buffer;
+
+  TraceScope(const char* path, uint32_t recordCount = 1 << 16) : buffer(trace_open(path, recordCount)) {}
+  ~TraceScope() { trace_close(buffer); }
+};
+
+// Argument type codes, i/u 32 bit ints, I/U 64 bit ints, d double, p pointer, s string
+template<typename T>
+constexpr char trace_code() {
+  if constexpr (std::is_same_v<T, const char*> || std::is_same_v<T, char*>) return 's';
+  else if constexpr (std::is_pointer_v<T>) return 'p';
+  else if constexpr (std::is_floating_point_v<T>) return 'd';
+  else if constexpr (std::is_enum_v<T>) return trace_code<std::underlying_type_t<T>>();
+  else {
+    static_assert(std::is_integral_v<T>, "Trace arguments must be numbers, enums, pointers or strings");
+    if constexpr (sizeof(T) <= 4) return std::is_signed_v<T> ? 'i' : 'u';
+    else return std::is_signed_v<T> ? 'I' : 'U';
+  }
+}
+
+constexpr uint32_t trace_code_size(char code) {
+  return code == 's' ? 1 : (code == 'i' || code == 'u') ? 4 : 8;
+}
+
+template<typename... Args>
+struct TraceSignature {
+  static constexpr char value[] = {trace_code<Args>()..., 0};
+};
+
+template<typename T>
+void trace_encode_arg(char*& cursor, const char* end, T value) {
+  constexpr char code = trace_code<T>();
+  if constexpr (code == 's') {
+    const char* text = value ? value : "(null)";
+    uint32_t length = 0;
+    while (text[length] && length < 255 && cursor + 1 + length < end) length++; // Truncates to leave room for the arguments after it
+    *cursor++ = (char)length;
+    memcpy(cursor, text, length);
+    cursor += length;
+  } else if constexpr (code == 'p') {
+    uint64_t raw = (uint64_t)(uintptr_t)value;
+    memcpy(cursor, &raw, 8);
+    cursor += 8;
+  } else if constexpr (code == 'd') {
+    double raw = (double)value;
+    memcpy(cursor, &raw, 8);
+    cursor += 8;
+  } else if constexpr (code == 'i' || code == 'u') {
+    uint32_t raw = (uint32_t)value;
+    memcpy(cursor, &raw, 4);
+    cursor += 4;
+  } else {
+    uint64_t raw = (uint64_t)value;
+    memcpy(cursor, &raw, 8);
+    cursor += 8;
+  }
+}
+
+template<typename... Args, size_t... I>
+void trace_encode(char*& cursor, char* end, std::index_sequence<I...>, Args... args) {
+  static_assert((trace_code_size(trace_code<Args>()) + ... + 0) <= TraceRecord::payloadSize, "Too many trace arguments");
+  static_assert(sizeof...(Args) < 16, "Too many trace arguments");
+  if constexpr (sizeof...(Args) > 0) {
+    constexpr uint32_t sizes[] = {trace_code_size(trace_code<Args>())...};
+    auto reserved_after = [&](size_t idx) {
+      uint32_t total = 0;
+      for (size_t j = idx + 1; j < sizeof...(Args); j++) total += sizes[j];
+      return total;
+    };
+    (trace_encode_arg(cursor, end - reserved_after(I), args), ...);
+  }
+}
+
+template<typename... Args>
+void _trace(TraceSite& site, Args... args) {
+  TraceBuffer* buffer = traceActive;
+  if (!buffer) return;
+
+  uint32_t key = site.key.load(std::memory_order_relaxed);
+  uint16_t id = (uint16_t)key;
+  if ((key >> 16) != buffer->serial || !id) {
+    id = trace_register(*buffer, site, TraceSignature<Args...>::value);
+    if (!id) return; // Site table full
+  }
+  if (!traceThreadId) traceThreadId = trace_os_thread_id();
+
+  // Size the ring so no writer gets lapped mid record, a lapped slot can end up mixing two records
+  uint64_t pos = buffer->writePos->fetch_add(1, std::memory_order_relaxed);
+  TraceRecord& record = buffer->records[pos & buffer->mask];
+  record.seq.store(0, std::memory_order_relaxed);
+  record.tsc = read_cycle_counter();
+  record.site = id;
+  record.thread = traceThreadId;
+  char* cursor = record.payload;
+  trace_encode(cursor, record.payload + TraceRecord::payloadSize, std::index_sequence_for<Args...>{}, args...);
+  record.size = (uint16_t)(cursor - record.payload);
+  record.seq.store(pos + 1, std::memory_order_release);
+}
+
+#if TRACE_ENABLED
+  #define TRACE(fmt, ...) { static TraceSite _traceSite(fmt, __FILE__, __LINE__); _trace(_traceSite, ##__VA_ARGS__); }
+#else
+  #define TRACE(fmt, ...) ((void)0);
+#endif
+
+// NOTE: Profiler
+// PROFILE_SCOPE zones, PROFILE_COUNTER values & PROFILE_FRAME markers are recorded into one ring
+// per thread, allocated from the Arena handed to profiler_create. profiler_write_chrome exports the
+// rings as Chrome about:tracing / Perfetto JSON. The Profiler is created by the host & kept in
+// GameState, a reloaded library attaches to it again & finds its thread's ring by OS thread id.
+// Zone names are copied into the Profiler as the unloaded library's string literals go away.
+#ifndef PROFILE_ENABLED
+  #define PROFILE_ENABLED 1
+#endif
+
+class Arena;
+
+enum class ProfileEventType : uint8_t {
+  Zone,
+  Counter,
+  Frame
+};
+
+struct ProfileEvent {
+  uint64_t start; // Cycle counter
+  union {
+    uint64_t duration; // Zone, in cycles
+    double value; // Counter
+    uint64_t frame; // Frame
+  };
+  uint16_t name;
+  ProfileEventType type;
+  uint8_t depth; // Zone nesting, 0 for outermost
+};
+
+struct ProfileThread {
+  ProfileEvent* events;
+  uint64_t mask; // Event count - 1
+  std::atomic<uint64_t> writePos; // Only the owning thread writes, exports read
+  uint32_t osThreadId;
+  uint32_t depth; // Zones currently open
+};
+
+struct ProfileSite {
+  const char* name;
+  std::atomic<uint32_t> key; // (profiler serial << 16) | name id, 0 until registered with the active profiler
+
+  constexpr ProfileSite(const char* _name) : name(_name), key(0) {}
+};
+
+struct Profiler {
+  static constexpr uint32_t maxThreads = 64;
+  static constexpr uint32_t maxNames = 1024;
+  static constexpr uint32_t nameSize = 64;
+  Arena* arena; // Thread rings are allocated on first use
+  uint64_t eventsPerThread;
+  uint64_t startTsc;
+  uint64_t startNs; // Steady clock
+  std::atomic<uint64_t> frame;
+  std::atomic<bool> registering; // Guards threads, names & the arena
+  uint16_t serial;
+  uint32_t threadCount;
+  uint32_t nameCount; // Name ids start at 1
+  ProfileThread* threads[maxThreads];
+  char names[maxNames][nameSize];
+};
+
+inline Profiler* profilerActive = nullptr; // Per module, libraries pick the host's profiler up with profiler_attach
+inline thread_local ProfileThread* profileThread = nullptr;
+inline thread_local uint16_t profileThreadSerial = 0;
+
+Profiler* profiler_create(Arena& arena, uint32_t eventsPerThread = 1 << 16); // Rounds up to a power of two, becomes active
+void profiler_attach(Profiler* profiler);
+ProfileThread* profile_register_thread(Profiler& profiler); // nullptr once maxThreads or the arena runs out
+uint16_t profile_register(Profiler& profiler, ProfileSite& site); // 0 once the name table is full
+bool profiler_write_chrome(Profiler& profiler, const char* path);
+
+inline ProfileThread* profile_thread() {
+  Profiler* profiler = profilerActive;
+  if (!profiler) return nullptr;
+  if (profileThreadSerial != profiler->serial) { // Failed registrations aren't retried either
+    profileThread = profile_register_thread(*profiler);
+    profileThreadSerial = profiler->serial;
+  }
+  return profileThread;
+}
+
+inline uint16_t profile_name(Profiler& profiler, ProfileSite& site) {
+  uint32_t key = site.key.load(std::memory_order_relaxed);
+  if ((key >> 16) == profiler.serial && (uint16_t)key) return (uint16_t)key;
+  return profile_register(profiler, site);
+}
+
+inline void profile_push(ProfileThread& thread, const ProfileEvent& event) {
+  uint64_t pos = thread.writePos.load(std::memory_order_relaxed);
+  thread.events[pos & thread.mask] = event;
+  thread.writePos.store(pos + 1, std::memory_order_release);
+}
+
+struct ProfileZone {
+  ProfileThread* thread;
+  uint64_t start = 0;
+  uint16_t name = 0;
+
+  ProfileZone(const ProfileZone&) = delete;
+  ProfileZone& operator=(const ProfileZone&) = delete;
+  ProfileZone(ProfileZone&& other) = delete;
+  ProfileZone& operator=(ProfileZone&& other) = delete;
+
+  explicit ProfileZone(ProfileSite& site) : thread(profile_thread()) {
+    if (!thread) return;
+    name = profile_name(*profilerActive, site);
+    thread->depth++;
+    start = read_cycle_counter();
+  }
+
+  ~ProfileZone() { // Recorded on close, so a zone is one event & the ring never splits a begin from its end
+    if (!thread) return;
+    ProfileEvent event;
+    event.duration = read_cycle_counter() - start;
+    event.start = start;
+    event.name = name;
+    event.type = ProfileEventType::Zone;
+    thread->depth--;
+    event.depth = (uint8_t)std::min<uint32_t>(thread->depth, 255);
+    profile_push(*thread, event);
+  }
+};
+
+inline void profile_counter(ProfileSite& site, double value) {
+  ProfileThread* thread = profile_thread();
+  if (!thread) return;
+  ProfileEvent event;
+  event.value = value;
+  event.start = read_cycle_counter();
+  event.name = profile_name(*profilerActive, site);
+  event.type = ProfileEventType::Counter;
+  event.depth = 0;
+  profile_push(*thread, event);
+}
+
+inline void profile_frame() {
+  ProfileThread* thread = profile_thread();
+  if (!thread) return;
+  ProfileEvent event;
+  event.frame = profilerActive->frame.fetch_add(1, std::memory_order_relaxed) + 1;
+  event.start = read_cycle_counter();
+  event.name = 0;
+  event.type = ProfileEventType::Frame;
+  event.depth = 0;
+  profile_push(*thread, event);
+}
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#if PROFILE_ENABLED
+  #define PROFILE_SCOPE(name) \
+    static ProfileSite PROFILE_CONCAT(_profileSite, __LINE__)(name); \
+    ProfileZone PROFILE_CONCAT(_profileZone, __LINE__)(PROFILE_CONCAT(_profileSite, __LINE__));
+  #define PROFILE_COUNTER(name, value) { static ProfileSite _profileSite(name); profile_counter(_profileSite, (double)(value)); }
+  #define PROFILE_FRAME() profile_frame();
+#else
+  #define PROFILE_SCOPE(name) ((void)0);
+  #define PROFILE_COUNTER(name, value) ((void)0);
+  #define PROFILE_FRAME() ((void)0);
+#endif
+
 // NOTE: Array
 
 template <typename T>
@@ -405,877 +848,3178 @@ void swap(T& a, T& b) {
   b = temp;
 }
 
-template<typename T>
-uint32_t partition(T* arr, uint32_t low, uint32_t high) {
-  T pivot = arr[high];
-  uint32_t i = low - 1;
+// NOTE: Sorting
 
-  for(uint32_t j = low; j < high; j++) {
-    if(arr[j] <= pivot) {
-      i++;
-      swap(arr[i], arr[j]);
+struct SortLess {
+  template<typename A, typename B>
+  bool operator()(const A& a, const B& b) const { return a < b; }
+};
+
+struct SortIdentity {
+  template<typename T>
+  const T& operator()(const T& value) const { return value; }
+};
+
+// Pattern-defeating quicksort (Orson Peters): median of 3 / ninther pivots, insertion
+// sort for small ranges, pattern breaking swaps & a heapsort fallback for bad inputs.
+struct PdqSort {
+  static constexpr size_t insertionSortThreshold = 24;
+  static constexpr size_t nintherThreshold = 128;
+  static constexpr size_t partialInsertionSortLimit = 8;
+  static constexpr size_t blockSize = 64;
+
+  template<typename T>
+  struct PartitionResult {
+    T* pivot;
+    bool alreadyPartitioned;
+  };
+
+  template<typename T, typename Less>
+  static void insertion_sort(T* begin, T* end, Less& less) { // Stable
+    if (begin == end) return;
+    for (T* cur = begin + 1; cur != end; ++cur) {
+      T* sift = cur;
+      T* sift_1 = cur - 1;
+      if (less(*sift, *sift_1)) {
+        T tmp = std::move(*sift);
+        do {
+          *sift-- = std::move(*sift_1);
+        } while (sift != begin && less(tmp, *--sift_1));
+        *sift = std::move(tmp);
+      }
     }
   }
-  swap(arr[i + 1], arr[high]);
-  return i + 1;
-}
 
-template<typename T>
-void quicksort_internal(T* arr, uint32_t low, uint32_t high) {
-  if(low < high) {
-    uint32_t pi = partition(arr, low, high);
-    quicksort_internal(arr, low, pi - 1);
-    quicksort_internal(arr, pi + 1, high);
+  template<typename T, typename Less>
+  static void unguarded_insertion_sort(T* begin, T* end, Less& less) { // *(begin - 1) is a lower bound
+    if (begin == end) return;
+    for (T* cur = begin + 1; cur != end; ++cur) {
+      T* sift = cur;
+      T* sift_1 = cur - 1;
+      if (less(*sift, *sift_1)) {
+        T tmp = std::move(*sift);
+        do {
+          *sift-- = std::move(*sift_1);
+        } while (less(tmp, *--sift_1));
+        *sift = std::move(tmp);
+      }
+    }
   }
-}
-
-template<typename T, uint32_t N>
-void quicksort(ArrayCT<T, N>& arr) {
-  if(arr.count <= 1) return;
-  quicksort_internal(arr.elements, 0, arr.count - 1);
-}
 
-template<typename T>
-void quicksort(ArrayRT<T>& arr) {
-  if(arr.count <= 1) return;
-  quicksort_internal(arr.elements, 0, arr.count - 1);
-}
+  // Gives up after partialInsertionSortLimit moves, returns whether the range got sorted
+  template<typename T, typename Less>
+  static bool partial_insertion_sort(T* begin, T* end, Less& less) {
+    if (begin == end) return true;
+    size_t limit = 0;
+    for (T* cur = begin + 1; cur != end; ++cur) {
+      T* sift = cur;
+      T* sift_1 = cur - 1;
+      if (less(*sift, *sift_1)) {
+        T tmp = std::move(*sift);
+        do {
+          *sift-- = std::move(*sift_1);
+        } while (sift != begin && less(tmp, *--sift_1));
+        *sift = std::move(tmp);
+        limit += cur - sift;
+      }
+      if (limit > partialInsertionSortLimit) return false;
+    }
+    return true;
+  }
 
-template<typename T, uint32_t N>
-void quicksort(ArrayCT<T, N>& arr, uint32_t start, uint32_t end) {
-  LOG_ASSERT(end < arr.count, "Index out of bounds!");
-  if(end - start <= 0) return;
-  quicksort_internal(arr.elements, start, end);
-}
+  template<typename T>
+  static void swap_elements(T* a, T* b) {
+    T tmp = std::move(*a);
+    *a = std::move(*b);
+    *b = std::move(tmp);
+  }
 
-template<typename T>
-void quicksort(ArrayRT<T>& arr, uint32_t start, uint32_t end) {
-  LOG_ASSERT(start >= 0 && end < arr.count, "Index out of bounds!");
-  if(end - start <= 0) return;
-  quicksort_internal(arr.elements, start, end);
-}
+  template<typename T, typename Less>
+  static void sort2(T* a, T* b, Less& less) {
+    if (less(*b, *a)) swap_elements(a, b);
+  }
 
-//NOTE: Map
+  template<typename T, typename Less>
+  static void sort3(T* a, T* b, T* c, Less& less) {
+    sort2(a, b, less);
+    sort2(b, c, less);
+    sort2(a, b, less);
+  }
 
-template<typename K>
-struct KeyCompare {
-  static bool equals(const K& a, const K& b) {
-    // Handle char* types
-    if (sizeof(K) == sizeof(char*)) {
-      const char* str_a = (const char*)a;
-      const char* str_b = (const char*)b;
-      return str_a && str_b && strcmp(str_a, str_b) == 0;
-    }
-    // Handle char arrays
-    else if (sizeof(K) > 1 && ((const char*)&a)[0] != '\0') {
-      return strcmp((const char*)&a, (const char*)&b) == 0;
-    }
-    // Handle 32-bit types
-    else if (sizeof(K) == sizeof(uint32_t)) {
-      return a == b;
-    }
-    // Handle 64-bit types
-    else if (sizeof(K) == sizeof(uint64_t)) {
-      return a == b;
+  template<typename T, typename Less>
+  static void sift_down(T* begin, size_t size, size_t root, Less& less) {
+    while (true) {
+      size_t child = 2 * root + 1;
+      if (child >= size) return;
+      if (child + 1 < size && less(begin[child], begin[child + 1])) child++;
+      if (!less(begin[root], begin[child])) return;
+      swap_elements(begin + root, begin + child);
+      root = child;
     }
-    // Default case
-    return memcmp(&a, &b, sizeof(K)) == 0;
   }
-};
-
-template <typename KeyType, typename ValueType>
-struct Entry {
-  KeyType key;
-  ValueType value;
 
-  bool operator==(const Entry& other) const {
-    return KeyCompare<KeyType>::equals(key, other.key);
+  template<typename T, typename Less>
+  static void heapsort(T* begin, T* end, Less& less) {
+    size_t size = end - begin;
+    for (size_t i = size / 2; i-- > 0;) sift_down(begin, size, i, less);
+    for (size_t last = size; last > 1;) {
+      swap_elements(begin, begin + --last);
+      sift_down(begin, last, 0, less);
+    }
   }
-};
 
-template <typename KeyType, typename ValueType>
-struct MapIterator {
-  Entry<KeyType, ValueType>* ptr;
-  Entry<KeyType, ValueType>* end;
+  // Elements equal to the pivot go to the right, *begin is the pivot
+  template<typename T, typename Less>
+  static PartitionResult<T> partition_right(T* begin, T* end, Less& less) {
+    T pivot = std::move(*begin);
+    T* first = begin;
+    T* last = end;
 
-  MapIterator(const MapIterator&) = delete;
-  MapIterator& operator=(const MapIterator&) = delete;
-  MapIterator(MapIterator&& other) = delete;
-  MapIterator& operator=(MapIterator&& other) = delete;
+    while (less(*++first, pivot));
+    if (first - 1 == begin) {
+      while (first < last && !less(*--last, pivot));
+    } else {
+      while (!less(*--last, pivot));
+    }
 
-  MapIterator(Entry<KeyType, ValueType>* start, Entry<KeyType, ValueType>* end)
-  : ptr(start), end(end) {}
+    bool alreadyPartitioned = first >= last;
+    while (first < last) {
+      swap_elements(first, last);
+      while (less(*++first, pivot));
+      while (!less(*--last, pivot));
+    }
 
-  MapIterator& operator++() {
-    if (ptr != end) {
-      ++ptr;
+    T* pivotPos = first - 1;
+    *begin = std::move(*pivotPos);
+    *pivotPos = std::move(pivot);
+    return {pivotPos, alreadyPartitioned};
+  }
+
+  template<typename T>
+  static void swap_offsets(T* first, T* last, unsigned char* offsetsL, unsigned char* offsetsR,
+                           size_t num, bool useSwaps) {
+    if (useSwaps) {
+      for (size_t i = 0; i < num; ++i) swap_elements(first + offsetsL[i], last - offsetsR[i]);
+    } else if (num > 0) { // Cyclic permutation, fewer moves than swapping pairs
+      T* l = first + offsetsL[0];
+      T* r = last - offsetsR[0];
+      T tmp = std::move(*l);
+      *l = std::move(*r);
+      for (size_t i = 1; i < num; ++i) {
+        l = first + offsetsL[i];
+        *r = std::move(*l);
+        r = last - offsetsR[i];
+        *l = std::move(*r);
+      }
+      *r = std::move(tmp);
     }
-    return *this;
   }
 
-  bool operator!=(const MapIterator& other) const { return ptr != other.ptr; }
-  Entry<KeyType, ValueType>& operator*() const { return *ptr; }
-  Entry<KeyType, ValueType>* operator->() const { return ptr; }
+  // BlockQuicksort partitioning: comparisons only write offsets, so there is no
+  // branch on their result to mispredict. Used when comparing is cheap.
+  template<typename T, typename Less>
+  static PartitionResult<T> partition_right_branchless(T* begin, T* end, Less& less) {
+    T pivot = std::move(*begin);
+    T* first = begin;
+    T* last = end;
 
-  KeyType& key() const { return ptr->key; }
-  ValueType& value() const { return ptr->value; }
-};
+    while (less(*++first, pivot));
+    if (first - 1 == begin) {
+      while (first < last && !less(*--last, pivot));
+    } else {
+      while (!less(*--last, pivot));
+    }
 
-template <typename KeyType, typename ValueType, uint32_t N>
-struct MapCT {
-  ArrayCT<Entry<KeyType, ValueType>, N> entries;
+    bool alreadyPartitioned = first >= last;
+    if (!alreadyPartitioned) {
+      swap_elements(first, last);
+      ++first;
+
+      unsigned char offsetsL[blockSize];
+      unsigned char offsetsR[blockSize];
+      T* offsetsLBase = first;
+      T* offsetsRBase = last;
+      size_t numL = 0, numR = 0, startL = 0, startR = 0;
+
+      while (first < last) {
+        size_t numUnknown = last - first;
+        size_t leftSplit = numL == 0 ? (numR == 0 ? numUnknown / 2 : numUnknown) : 0;
+        size_t rightSplit = numR == 0 ? (numUnknown - leftSplit) : 0;
+
+        size_t leftCount = leftSplit < blockSize ? leftSplit : blockSize;
+        for (size_t i = 0; i < leftCount; ++i) {
+          offsetsL[numL] = (unsigned char)i;
+          numL += !less(*first, pivot);
+          ++first;
+        }
+        size_t rightCount = rightSplit < blockSize ? rightSplit : blockSize;
+        for (size_t i = 0; i < rightCount;) {
+          offsetsR[numR] = (unsigned char)++i;
+          numR += less(*--last, pivot);
+        }
 
-  MapCT() = default;
-  MapCT(const MapCT&) = delete;
-  MapCT& operator=(const MapCT&) = delete;
-  MapCT(MapCT&& other) = delete;
-  MapCT& operator=(MapCT&& other) = delete;
+        size_t num = numL < numR ? numL : numR;
+        swap_offsets(offsetsLBase, offsetsRBase, offsetsL + startL, offsetsR + startR, num, numL == numR);
+        numL -= num;
+        numR -= num;
+        startL += num;
+        startR += num;
+        if (numL == 0) {
+          startL = 0;
+          offsetsLBase = first;
+        }
+        if (numR == 0) {
+          startR = 0;
+          offsetsRBase = last;
+        }
+      }
 
-  void init() {
-    clear();
-  }
+      // One side is done, move the leftovers of the other next to the boundary
+      if (numL) {
+        unsigned char* offsets = offsetsL + startL;
+        while (numL--) swap_elements(offsetsLBase + offsets[numL], --last);
+        first = last;
+      }
+      if (numR) {
+        unsigned char* offsets = offsetsR + startR;
+        while (numR--) swap_elements(offsetsRBase - offsets[numR], first), ++first;
+        last = first;
+      }
+    }
 
-  // Linear search to find an entry by key
-  uint32_t find(const KeyType& key) const {
-    Entry<KeyType, ValueType> temp{key, ValueType{}};
-    return entries.find(temp);
+    T* pivotPos = first - 1;
+    *begin = std::move(*pivotPos);
+    *pivotPos = std::move(pivot);
+    return {pivotPos, alreadyPartitioned};
   }
 
-  bool contains(const KeyType& key) const {
-    Entry<KeyType, ValueType> temp{key, ValueType{}};
-    return entries.contains(temp);
+  // Elements equal to the pivot go to the left, used when the pivot equals *(begin - 1)
+  template<typename T, typename Less>
+  static T* partition_left(T* begin, T* end, Less& less) {
+    T pivot = std::move(*begin);
+    T* first = begin;
+    T* last = end;
+
+    while (less(pivot, *--last));
+    if (last + 1 == end) {
+      while (first < last && !less(pivot, *++first));
+    } else {
+      while (!less(pivot, *++first));
+    }
+
+    while (first < last) {
+      swap_elements(first, last);
+      while (less(pivot, *--last));
+      while (!less(pivot, *++first));
+    }
+
+    T* pivotPos = last;
+    *begin = std::move(*pivotPos);
+    *pivotPos = std::move(pivot);
+    return pivotPos;
   }
 
-  ValueType& get(const KeyType key) {
-    uint32_t idx = find(key);
-    if (idx == UINT32_MAX) {
-      idx = entries.add(Entry<KeyType, ValueType>{key, ValueType{}});
+  template<bool Branchless, typename T, typename Less>
+  static void sort_loop(T* begin, T* end, Less& less, int badAllowed, bool leftmost) {
+    while (true) {
+      size_t size = end - begin;
+      if (size < insertionSortThreshold) {
+        if (leftmost) insertion_sort(begin, end, less);
+        else unguarded_insertion_sort(begin, end, less);
+        return;
+      }
+
+      size_t s2 = size / 2;
+      if (size > nintherThreshold) {
+        sort3(begin, begin + s2, end - 1, less);
+        sort3(begin + 1, begin + (s2 - 1), end - 2, less);
+        sort3(begin + 2, begin + (s2 + 1), end - 3, less);
+        sort3(begin + (s2 - 1), begin + s2, begin + (s2 + 1), less);
+        swap_elements(begin, begin + s2);
+      } else {
+        sort3(begin + s2, begin, end - 1, less);
+      }
+
+      // Pivot equal to the element before this range, everything <= pivot is already in place
+      if (!leftmost && !less(*(begin - 1), *begin)) {
+        begin = partition_left(begin, end, less) + 1;
+        continue;
+      }
+
+      PartitionResult<T> part = Branchless ? partition_right_branchless(begin, end, less)
+                                           : partition_right(begin, end, less);
+      T* pivotPos = part.pivot;
+      size_t lSize = pivotPos - begin;
+      size_t rSize = end - (pivotPos + 1);
+      bool highlyUnbalanced = lSize < size / 8 || rSize < size / 8;
+
+      if (highlyUnbalanced) {
+        if (--badAllowed == 0) {
+          heapsort(begin, end, less);
+          return;
+        }
+
+        // Break up patterns that produced the bad pivot
+        if (lSize >= insertionSortThreshold) {
+          swap_elements(begin, begin + lSize / 4);
+          swap_elements(pivotPos - 1, pivotPos - lSize / 4);
+          if (lSize > nintherThreshold) {
+            swap_elements(begin + 1, begin + (lSize / 4 + 1));
+            swap_elements(begin + 2, begin + (lSize / 4 + 2));
+            swap_elements(pivotPos - 2, pivotPos - (lSize / 4 + 1));
+            swap_elements(pivotPos - 3, pivotPos - (lSize / 4 + 2));
+          }
+        }
+        if (rSize >= insertionSortThreshold) {
+          swap_elements(pivotPos + 1, pivotPos + (1 + rSize / 4));
+          swap_elements(end - 1, end - rSize / 4);
+          if (rSize > nintherThreshold) {
+            swap_elements(pivotPos + 2, pivotPos + (2 + rSize / 4));
+            swap_elements(pivotPos + 3, pivotPos + (3 + rSize / 4));
+            swap_elements(end - 2, end - (1 + rSize / 4));
+            swap_elements(end - 3, end - (2 + rSize / 4));
+          }
+        }
+      } else if (part.alreadyPartitioned &&
+                 partial_insertion_sort(begin, pivotPos, less) &&
+                 partial_insertion_sort(pivotPos + 1, end, less)) {
+        return; // Nearly sorted input finishes here in O(n)
+      }
+
+      sort_loop<Branchless>(begin, pivotPos, less, badAllowed, leftmost);
+      begin = pivotPos + 1;
+      leftmost = false;
     }
-    return entries[idx].value;
   }
 
-  ValueType& operator[](const KeyType key) {
-    return get(key);
+  template<typename T, typename Compare, typename Project>
+  static void sort(T* begin, T* end, Compare& comp, Project& proj) {
+    if (end - begin < 2) return;
+    auto less = [&](const T& a, const T& b) -> bool { return comp(proj(a), proj(b)); };
+
+    int badAllowed = 1;
+    for (size_t size = end - begin; size >>= 1;) badAllowed++; // log2(size)
+
+    using Key = std::decay_t<decltype(proj(*begin))>;
+    constexpr bool branchless = std::is_arithmetic_v<Key> || std::is_pointer_v<Key>;
+    sort_loop<branchless>(begin, end, less, badAllowed, true);
   }
 
-  void remove(const KeyType& key) {
-    uint32_t idx = find(key);
-    if (idx != UINT32_MAX) {
-      entries.remove(idx);
+  // Top down merge sort, insertion sorted runs & a buffer of half the range
+  template<typename T, typename Less>
+  static void merge_sort(T* begin, T* end, T* buffer, Less& less) {
+    size_t size = end - begin;
+    if (size <= insertionSortThreshold) {
+      insertion_sort(begin, end, less);
+      return;
     }
-  }
 
-  void ordered_remove(const KeyType& key) {
-    uint32_t idx = find(key);
-    if (idx != UINT32_MAX) {
-      entries.ordered_remove(idx);
+    T* mid = begin + size / 2;
+    merge_sort(begin, mid, buffer, less);
+    merge_sort(mid, end, buffer, less);
+    if (!less(*mid, *(mid - 1))) return; // Halves already in order
+
+    T* bufferEnd = buffer;
+    for (T* it = begin; it != mid; ++it) *bufferEnd++ = std::move(*it);
+
+    T* l = buffer;
+    T* r = mid;
+    T* out = begin;
+    while (l != bufferEnd && r != end) {
+      *out++ = less(*r, *l) ? std::move(*r++) : std::move(*l++); // Ties take the left, keeping order
     }
+    while (l != bufferEnd) *out++ = std::move(*l++);
   }
 
-  bool empty() const {
-    return entries.empty();
+  // Merges two sorted ranges into out, ties take the left range
+  template<typename T, typename Less>
+  static void merge(T* l, T* lEnd, T* r, T* rEnd, T* out, Less& less) {
+    while (l != lEnd && r != rEnd) *out++ = less(*r, *l) ? std::move(*r++) : std::move(*l++);
+    while (l != lEnd) *out++ = std::move(*l++);
+    while (r != rEnd) *out++ = std::move(*r++);
   }
 
-  uint32_t size() const {
-    return entries.size();
+  // buffer must hold (end - begin) / 2 elements
+  template<typename T, typename Compare, typename Project>
+  static void stable_sort(T* begin, T* end, T* buffer, Compare& comp, Project& proj) {
+    if (end - begin < 2) return;
+    auto less = [&](const T& a, const T& b) -> bool { return comp(proj(a), proj(b)); };
+    merge_sort(begin, end, buffer, less);
   }
+};
 
-  uint32_t capacity() const {
-    return entries.capacity();
+// Maps a key to an unsigned integer with the same ordering, used by radix_sort
+template<typename K>
+auto radix_key(K key) {
+  static_assert(std::is_arithmetic_v<K> || std::is_enum_v<K>, "radix_key needs an integer, float or enum key");
+  if constexpr (std::is_enum_v<K>) {
+    return radix_key((std::underlying_type_t<K>)key);
+  } else if constexpr (std::is_same_v<K, float>) {
+    uint32_t bits;
+    memcpy(&bits, &key, sizeof(bits));
+    return bits ^ ((uint32_t)-(int32_t)(bits >> 31) | 0x80000000u); // Negatives flip all bits, positives the sign
+  } else if constexpr (std::is_same_v<K, double>) {
+    uint64_t bits;
+    memcpy(&bits, &key, sizeof(bits));
+    return bits ^ ((uint64_t)-(int64_t)(bits >> 63) | 0x8000000000000000ull);
+  } else if constexpr (std::is_signed_v<K>) {
+    using U = std::make_unsigned_t<K>;
+    return (U)((U)key ^ ((U)1 << (sizeof(K) * 8 - 1)));
+  } else {
+    return key;
   }
+}
 
-  bool is_full() const {
-    return size() == capacity();
-  }
+// Draw order key, sorts by material, then mesh, then depth (front to back)
+inline uint64_t pack_sort_key(uint16_t material, uint16_t mesh, float depth) {
+  return ((uint64_t)material << 48) | ((uint64_t)mesh << 32) | radix_key(depth);
+}
 
-  void clear() {
-    entries.clear();
+// Sorts by comp(proj(a), proj(b)), e.g. sort(units, SortLess{}, [](const Unit& u) { return u.order; })
+template<typename T, uint32_t N, typename Compare = SortLess, typename Project = SortIdentity>
+void sort(ArrayCT<T, N>& arr, Compare comp = Compare{}, Project proj = Project{}) {
+  PdqSort::sort(arr.elements, arr.elements + arr.count, comp, proj);
+}
+
+template<typename T, typename Compare = SortLess, typename Project = SortIdentity>
+void sort(ArrayRT<T>& arr, Compare comp = Compare{}, Project proj = Project{}) {
+  PdqSort::sort(arr.elements, arr.elements + arr.count, comp, proj);
+}
+
+template<typename T, uint32_t N>
+void quicksort(ArrayCT<T, N>& arr) {
+  sort(arr);
+}
+
+template<typename T>
+void quicksort(ArrayRT<T>& arr) {
+  sort(arr);
+}
+
+template<typename T, uint32_t N>
+void quicksort(ArrayCT<T, N>& arr, uint32_t start, uint32_t end) { // Sorts [start, end]
+  LOG_ASSERT(end < arr.count, "Index out of bounds!");
+  if(end <= start) return;
+  SortLess comp;
+  SortIdentity proj;
+  PdqSort::sort(arr.elements + start, arr.elements + end + 1, comp, proj);
+}
+
+template<typename T>
+void quicksort(ArrayRT<T>& arr, uint32_t start, uint32_t end) { // Sorts [start, end]
+  LOG_ASSERT(end < arr.count, "Index out of bounds!");
+  if(end <= start) return;
+  SortLess comp;
+  SortIdentity proj;
+  PdqSort::sort(arr.elements + start, arr.elements + end + 1, comp, proj);
+}
+
+// NOTE: Structure of arrays
+
+template<typename T>
+struct Span {
+  T* data;
+  uint32_t count;
+
+  T& operator[](uint32_t idx) const {
+    LOG_ASSERT(idx < count, "Index out of bounds!");
+    return data[idx];
   }
 
-  using Iterator = MapIterator<KeyType, ValueType>;
-  Iterator begin() { return Iterator(entries.elements, entries.elements + entries.count); }
-  Iterator end() { return Iterator(entries.elements + entries.count, entries.elements + entries.count); }
+  T* begin() const { return data; }
+  T* end() const { return data + count; }
+  uint32_t size() const { return count; }
 };
 
-template <typename KeyType, typename ValueType>
-struct MapRT {
-  ArrayRT<Entry<KeyType, ValueType>>* entries; // set when allocated
+// One contiguous column per field, rows are kept in sync across columns.
+// e.g. SoART<Transform, float, bool>, loop over column<1>() for vectorized sweeps
+template<typename... Fields>
+struct SoART {
+  static_assert(sizeof...(Fields) > 0, "SoART needs at least one field");
+  static constexpr uint32_t columnCount = sizeof...(Fields);
+  static constexpr uint32_t columnAlignment = CACHE_LINE_SIZE; // Also covers the widest SIMD register
 
-  MapRT() = delete;
-  MapRT(const MapRT&) = delete;
-  MapRT& operator=(const MapRT&) = delete;
-  MapRT(MapRT&& other) = delete;
-  MapRT& operator=(MapRT&& other) = delete;
+  template<uint32_t I>
+  using Field = std::tuple_element_t<I, std::tuple<Fields...>>;
+  using Row = std::tuple<Fields&...>; // Proxy reference, auto [a, b] = soa[i];
 
-  void init(ArrayRT<Entry<KeyType, ValueType>>& Aentries) {
-    entries = &Aentries;
-    clear();
+  uint32_t maxElements;
+  uint32_t count;
+  void* columns[columnCount];
+
+  SoART() = default;
+  SoART(const SoART&) = delete;
+  SoART& operator=(const SoART&) = delete;
+  SoART(SoART&& other) = delete;
+  SoART& operator=(SoART&& other) = delete;
+
+  static uint32_t column_bytes(uint32_t size, uint32_t maxElements) {
+    return (size * maxElements + columnAlignment - 1) & ~(columnAlignment - 1);
   }
 
-  // Linear search to find an entry by key
-  uint32_t find(const KeyType& key) const {
-    Entry<KeyType, ValueType> temp{key, ValueType{}};
-    return entries->find(temp);
+  static uint32_t memory_size(uint32_t maxElements) {
+    return (column_bytes(sizeof(Fields), maxElements) + ...);
   }
 
-  bool contains(const KeyType& key) const {
-    Entry<KeyType, ValueType> temp{key, ValueType{}};
-    return entries->contains(temp);
+  void init(void* memory, uint32_t maxElements) { // memory must be columnAlignment aligned
+    LOG_ASSERT((uintptr_t)memory % columnAlignment == 0, "SoA memory is not aligned!");
+    this->maxElements = maxElements;
+    count = 0;
+    uintptr_t cursor = (uintptr_t)memory;
+    uint32_t column = 0;
+    ((columns[column++] = (void*)cursor, cursor += column_bytes(sizeof(Fields), maxElements)), ...);
   }
 
-  ValueType& get(const KeyType key) {
-    uint32_t idx = find(key);
-    if (idx == UINT32_MAX) {
-      idx = entries->add(Entry<KeyType, ValueType>{key, ValueType{}});
-    }
-    return entries->get(idx).value;
+  template<uint32_t I>
+  Field<I>* column_data() {
+    return (Field<I>*)columns[I];
   }
 
-  ValueType& operator[](const KeyType key) {
-    return get(key);
+  template<uint32_t I>
+  Span<Field<I>> column() {
+    return Span<Field<I>>{column_data<I>(), count};
   }
 
-  void remove(const KeyType& key) {
-    uint32_t idx = find(key);
-    if (idx != UINT32_MAX) {
-      entries->remove(idx);
-    }
+  template<uint32_t I>
+  Field<I>& get(uint32_t idx) {
+    LOG_ASSERT(idx < count, "Index out of bounds!");
+    return column_data<I>()[idx];
   }
 
-  void ordered_remove(const KeyType& key) {
-    uint32_t idx = find(key);
-    if (idx != UINT32_MAX) {
-      entries->ordered_remove(idx);
-    }
+  Row get(uint32_t idx) {
+    LOG_ASSERT(idx < count, "Index out of bounds!");
+    return row(idx, std::make_index_sequence<columnCount>{});
+  }
+
+  Row operator[](uint32_t idx) {
+    return get(idx);
+  }
+
+  uint32_t add(const Fields&... values) {
+    LOG_ASSERT(count + 1 <= maxElements, "SoA Full!");
+    set(count, std::make_index_sequence<columnCount>{}, values...);
+    return count++;
+  }
+
+  void remove(uint32_t idx) { //O(1) but doesn't keep order (swap to last index & decrement)
+    LOG_ASSERT(idx < count, "idx out of bounds!");
+    if (idx != --count) move_row(count, idx, std::make_index_sequence<columnCount>{});
+  }
+
+  void clear() {
+    count = 0;
+  }
+
+  bool is_full() const {
+    return count == maxElements;
   }
 
   bool empty() const {
-    return entries->empty();
+    return count == 0;
   }
 
   uint32_t size() const {
-    return entries->size();
+    return count;
   }
 
   uint32_t capacity() const {
-    return entries->capacity();
+    return maxElements;
   }
 
-  bool is_full() const {
-    return size() == capacity();
+private:
+  template<size_t... I>
+  Row row(uint32_t idx, std::index_sequence<I...>) {
+    return Row(column_data<I>()[idx]...);
   }
 
-  void clear() {
-    entries->clear();
+  template<size_t... I>
+  void set(uint32_t idx, std::index_sequence<I...>, const Fields&... values) {
+    ((column_data<I>()[idx] = values), ...);
   }
 
-  using Iterator = MapIterator<KeyType, ValueType>;
-  Iterator begin() { return Iterator(entries->elements, entries->elements + entries->count); }
-  Iterator end() { return Iterator(entries->elements + entries->count, entries->elements + entries->count); }
+  template<size_t... I>
+  void move_row(uint32_t from, uint32_t to, std::index_sequence<I...>) {
+    ((column_data<I>()[to] = std::move(column_data<I>()[from])), ...);
+  }
 };
 
-// NOTE: Hashmap
+// NOTE: Bitset
 
-template<typename T>
-struct Hash {
-  uint32_t operator()(const T& key) const = delete;
-};
+inline uint32_t count_trailing_zeros64(uint64_t x) {
+#ifdef _MSC_VER
+  unsigned long idx;
+  _BitScanForward64(&idx, x);
+  return idx;
+#else
+  return __builtin_ctzll(x);
+#endif
+}
 
-template<>
-struct Hash<int> {
-  uint32_t operator()(const int& key) const {
-    return key * 2654435761u;
+inline uint32_t popcount64(uint64_t x) {
+#ifdef _MSC_VER
+  return (uint32_t)__popcnt64(x);
+#else
+  return __builtin_popcountll(x);
+#endif
+}
+
+// Word loops shared by BitsetCT & BitsetRT, AVX2 handles 4 words per step when available
+struct BitWords {
+  enum class Op { And, Or, AndNot, Xor };
+
+  template<Op op>
+  static uint64_t apply(uint64_t a, uint64_t b) {
+    if constexpr (op == Op::And) return a & b;
+    else if constexpr (op == Op::Or) return a | b;
+    else if constexpr (op == Op::AndNot) return a & ~b;
+    else return a ^ b;
+  }
+
+  template<Op op>
+  static void combine(uint64_t* dst, const uint64_t* src, uint32_t wordCount) {
+    uint32_t i = 0;
+#ifdef __AVX2__
+    for (; i + 4 <= wordCount; i += 4) {
+      __m256i a = _mm256_loadu_si256((const __m256i*)(dst + i));
+      __m256i b = _mm256_loadu_si256((const __m256i*)(src + i));
+      __m256i r;
+      if constexpr (op == Op::And) r = _mm256_and_si256(a, b);
+      else if constexpr (op == Op::Or) r = _mm256_or_si256(a, b);
+      else if constexpr (op == Op::AndNot) r = _mm256_andnot_si256(b, a);
+      else r = _mm256_xor_si256(a, b);
+      _mm256_storeu_si256((__m256i*)(dst + i), r);
+    }
+#endif
+    for (; i < wordCount; i++) dst[i] = apply<op>(dst[i], src[i]);
   }
-};
 
-template<>
-struct Hash<const char*> {
-  unsigned long long operator()(const char* key) const {
-    // FNV-1a hash
-    unsigned long long hash = 14695981039346656037ULL;
-    for(; *key; ++key) {
-      hash ^= *key;
-      hash *= 1099511628211ULL;
+  static uint32_t count(const uint64_t* words, uint32_t wordCount) {
+    uint32_t total = 0;
+    for (uint32_t i = 0; i < wordCount; i++) total += popcount64(words[i]);
+    return total;
+  }
+
+  static bool any(const uint64_t* words, uint32_t wordCount) {
+    uint32_t i = 0;
+#ifdef __AVX2__
+    for (; i + 4 <= wordCount; i += 4) {
+      __m256i v = _mm256_loadu_si256((const __m256i*)(words + i));
+      if (!_mm256_testz_si256(v, v)) return true;
+    }
+#endif
+    for (; i < wordCount; i++) if (words[i]) return true;
+    return false;
+  }
+
+  static uint32_t find_next(const uint64_t* words, uint32_t wordCount, uint32_t from) { // First set bit >= from
+    uint32_t word = from / 64;
+    if (word >= wordCount) return UINT32_MAX;
+    uint64_t bits = words[word] & (~0ull << (from % 64));
+    while (!bits) {
+      if (++word == wordCount) return UINT32_MAX;
+      bits = words[word];
+    }
+    return word * 64 + count_trailing_zeros64(bits);
+  }
+
+  static void fill_range(uint64_t* words, uint32_t begin, uint32_t end, bool value) { // [begin, end)
+    if (begin >= end) return;
+    uint32_t first = begin / 64, last = (end - 1) / 64;
+    uint64_t firstMask = ~0ull << (begin % 64);
+    uint64_t lastMask = ~0ull >> (63 - (end - 1) % 64);
+    if (first == last) firstMask &= lastMask;
+    if (value) {
+      words[first] |= firstMask;
+      if (first != last) {
+        memset(words + first + 1, 0xFF, (last - first - 1) * sizeof(uint64_t));
+        words[last] |= lastMask;
+      }
+    } else {
+      words[first] &= ~firstMask;
+      if (first != last) {
+        memset(words + first + 1, 0, (last - first - 1) * sizeof(uint64_t));
+        words[last] &= ~lastMask;
+      }
     }
-    return hash;
   }
 };
 
-enum class EntryState : uint8_t {
-  Empty,
-  Occupied,
-  Dead
+struct BitIterator {
+  const uint64_t* words;
+  uint32_t wordCount;
+  uint32_t bit;
+
+  BitIterator& operator++() {
+    bit = BitWords::find_next(words, wordCount, bit + 1);
+    return *this;
+  }
+
+  bool operator!=(const BitIterator& other) const { return bit != other.bit; }
+  uint32_t operator*() const { return bit; }
 };
 
-template<typename K, typename V>
-struct HashEntry {
-  K key;
-  V value;
-  EntryState state = EntryState::Empty;
+// Shared bitset interface, Derived provides words(), word_count() & bit_count()
+template<typename Derived>
+struct BitsetOps {
+  Derived& self() { return *static_cast<Derived*>(this); }
+  const Derived& self() const { return *static_cast<const Derived*>(this); }
 
-  bool operator==(const HashEntry& other) const {
-    return KeyCompare<K>::equals(key, other.key);
+  bool test(uint32_t idx) const {
+    LOG_ASSERT(idx < self().bit_count(), "Index out of bounds!");
+    return (self().words()[idx / 64] >> (idx % 64)) & 1;
+  }
+
+  bool operator[](uint32_t idx) const {
+    return test(idx);
+  }
+
+  void set(uint32_t idx) {
+    LOG_ASSERT(idx < self().bit_count(), "Index out of bounds!");
+    self().words()[idx / 64] |= 1ull << (idx % 64);
+  }
+
+  void set(uint32_t idx, bool value) {
+    if (value) set(idx);
+    else reset(idx);
+  }
+
+  void reset(uint32_t idx) {
+    LOG_ASSERT(idx < self().bit_count(), "Index out of bounds!");
+    self().words()[idx / 64] &= ~(1ull << (idx % 64));
+  }
+
+  void flip(uint32_t idx) {
+    LOG_ASSERT(idx < self().bit_count(), "Index out of bounds!");
+    self().words()[idx / 64] ^= 1ull << (idx % 64);
+  }
+
+  void set_range(uint32_t begin, uint32_t end) { // [begin, end)
+    LOG_ASSERT(begin <= end && end <= self().bit_count(), "Range out of bounds!");
+    BitWords::fill_range(self().words(), begin, end, true);
+  }
+
+  void reset_range(uint32_t begin, uint32_t end) { // [begin, end)
+    LOG_ASSERT(begin <= end && end <= self().bit_count(), "Range out of bounds!");
+    BitWords::fill_range(self().words(), begin, end, false);
   }
+
+  void set_all() {
+    set_range(0, self().bit_count());
+  }
+
+  void clear() {
+    memset(self().words(), 0, self().word_count() * sizeof(uint64_t));
+  }
+
+  template<typename Other>
+  void and_with(const BitsetOps<Other>& other) {
+    LOG_ASSERT(other.self().bit_count() == self().bit_count(), "Bitset sizes differ!");
+    BitWords::combine<BitWords::Op::And>(self().words(), other.self().words(), self().word_count());
+  }
+
+  template<typename Other>
+  void or_with(const BitsetOps<Other>& other) {
+    LOG_ASSERT(other.self().bit_count() == self().bit_count(), "Bitset sizes differ!");
+    BitWords::combine<BitWords::Op::Or>(self().words(), other.self().words(), self().word_count());
+  }
+
+  template<typename Other>
+  void and_not_with(const BitsetOps<Other>& other) { // Clears the bits set in other
+    LOG_ASSERT(other.self().bit_count() == self().bit_count(), "Bitset sizes differ!");
+    BitWords::combine<BitWords::Op::AndNot>(self().words(), other.self().words(), self().word_count());
+  }
+
+  template<typename Other>
+  void xor_with(const BitsetOps<Other>& other) {
+    LOG_ASSERT(other.self().bit_count() == self().bit_count(), "Bitset sizes differ!");
+    BitWords::combine<BitWords::Op::Xor>(self().words(), other.self().words(), self().word_count());
+  }
+
+  uint32_t count() const {
+    return BitWords::count(self().words(), self().word_count());
+  }
+
+  bool any() const {
+    return BitWords::any(self().words(), self().word_count());
+  }
+
+  bool none() const {
+    return !any();
+  }
+
+  uint32_t find_first() const { // UINT32_MAX if no bit is set
+    return BitWords::find_next(self().words(), self().word_count(), 0);
+  }
+
+  uint32_t find_next(uint32_t idx) const { // First set bit after idx
+    return BitWords::find_next(self().words(), self().word_count(), idx + 1);
+  }
+
+  using Iterator = BitIterator; // Walks the set bits
+  Iterator begin() const { return Iterator{self().words(), self().word_count(), find_first()}; }
+  Iterator end() const { return Iterator{self().words(), self().word_count(), UINT32_MAX}; }
 };
 
-template<typename K, typename V>
-struct HashMapIterator {
-  HashEntry<K,V>* ptr;
-  HashEntry<K,V>* end;
+template<uint32_t N>
+struct BitsetCT : BitsetOps<BitsetCT<N>> {
+  static_assert(N > 0, "BitsetCT needs at least one bit");
+  static constexpr uint32_t bitCount = N;
+  static constexpr uint32_t wordCount = (N + 63) / 64;
+  alignas(32) uint64_t bits[wordCount] = {};
 
-  HashMapIterator(const HashMapIterator&) = delete;
-  HashMapIterator& operator=(const HashMapIterator&) = delete;
-  HashMapIterator(HashMapIterator&& other) = delete;
-  HashMapIterator& operator=(HashMapIterator&& other) = delete;
+  BitsetCT() = default;
+  BitsetCT(const BitsetCT&) = delete;
+  BitsetCT& operator=(const BitsetCT&) = delete;
+  BitsetCT(BitsetCT&& other) = delete;
+  BitsetCT& operator=(BitsetCT&& other) = delete;
 
-  HashMapIterator(HashEntry<K,V>* start, HashEntry<K,V>* end) 
-      : ptr(start), end(end) {
-    // Find first occupied entry
-    while (ptr != end && ptr->state != EntryState::Occupied) {
-      ++ptr;
+  void init() {
+    this->clear();
+  }
+
+  uint64_t* words() { return bits; }
+  const uint64_t* words() const { return bits; }
+  uint32_t word_count() const { return wordCount; }
+  uint32_t bit_count() const { return bitCount; }
+  uint32_t capacity() const { return bitCount; }
+};
+
+struct BitsetRT : BitsetOps<BitsetRT> {
+  uint32_t bitCount; // Set at runtime
+  uint32_t wordCount; // Set at runtime
+  uint64_t* bits; // Set at runtime
+
+  BitsetRT() = delete;
+  BitsetRT(const BitsetRT&) = delete;
+  BitsetRT& operator=(const BitsetRT&) = delete;
+  BitsetRT(BitsetRT&& other) = delete;
+  BitsetRT& operator=(BitsetRT&& other) = delete;
+
+  void init(uint64_t* _bits, uint32_t _bitCount) {
+    bitCount = _bitCount;
+    wordCount = (_bitCount + 63) / 64;
+    bits = _bits;
+    clear();
+  }
+
+  uint64_t* words() { return bits; }
+  const uint64_t* words() const { return bits; }
+  uint32_t word_count() const { return wordCount; }
+  uint32_t bit_count() const { return bitCount; }
+  uint32_t capacity() const { return bitCount; }
+};
+
+//NOTE: Map
+
+template<typename T, typename = void>
+struct has_equal_operator : std::false_type {};
+
+template<typename T>
+struct has_equal_operator<T, std::void_t<decltype(std::declval<const T&>() == std::declval<const T&>())>>
+  : std::true_type {};
+
+// Picks the comparison at compile time, specialize KeyCompare<K> for anything it rejects
+template<typename K>
+struct KeyCompare {
+  static constexpr bool isCString = std::is_same_v<K, const char*> || std::is_same_v<K, char*>;
+  static constexpr bool isCharArray = std::is_array_v<K> && std::is_same_v<std::remove_extent_t<K>, char>;
+  static constexpr bool isScalar = std::is_arithmetic_v<K> || std::is_enum_v<K> || std::is_pointer_v<K>;
+  static constexpr bool hasEquals = std::conjunction_v<std::is_class<K>, has_equal_operator<K>>;
+
+  static_assert(isCString || isCharArray || isScalar || hasEquals ||
+                std::has_unique_object_representations_v<K>,
+                "KeyCompare<K> can't compare this key type, add an operator== or specialize KeyCompare<K>");
+
+  static bool equals(const K& a, const K& b) {
+    if constexpr (isCString) {
+      if (a == b) return true;
+      return a && b && strcmp(a, b) == 0;
+    } else if constexpr (isCharArray) {
+      return strncmp(a, b, sizeof(K)) == 0;
+    } else if constexpr (isScalar || hasEquals) {
+      return a == b;
+    } else { // Padding free POD, every byte is part of the value
+      return memcmp(&a, &b, sizeof(K)) == 0;
     }
   }
+};
 
-  HashMapIterator& operator++() {
+template <typename KeyType, typename ValueType>
+struct Entry {
+  KeyType key;
+  ValueType value;
+
+  bool operator==(const Entry& other) const {
+    return KeyCompare<KeyType>::equals(key, other.key);
+  }
+};
+
+template <typename KeyType, typename ValueType>
+struct MapIterator {
+  Entry<KeyType, ValueType>* ptr;
+  Entry<KeyType, ValueType>* end;
+
+  MapIterator(const MapIterator&) = delete;
+  MapIterator& operator=(const MapIterator&) = delete;
+  MapIterator(MapIterator&& other) = delete;
+  MapIterator& operator=(MapIterator&& other) = delete;
+
+  MapIterator(Entry<KeyType, ValueType>* start, Entry<KeyType, ValueType>* end)
+  : ptr(start), end(end) {}
+
+  MapIterator& operator++() {
     if (ptr != end) {
       ++ptr;
-      // Skip to next occupied entry
-      while (ptr != end && ptr->state != EntryState::Occupied) {
-        ++ptr;
-      }
     }
     return *this;
   }
 
-  bool operator!=(const HashMapIterator& other) const { return ptr != other.ptr; }
-  HashEntry<K,V>& operator*() const { return *ptr; }
-  HashEntry<K,V>* operator->() const { return ptr; }
+  bool operator!=(const MapIterator& other) const { return ptr != other.ptr; }
+  Entry<KeyType, ValueType>& operator*() const { return *ptr; }
+  Entry<KeyType, ValueType>* operator->() const { return ptr; }
 
-  K& key() const { return ptr->key; }
-  V& value() const { return ptr->value; }
+  KeyType& key() const { return ptr->key; }
+  ValueType& value() const { return ptr->value; }
 };
 
-template<typename KeyType, typename ValueType, uint32_t N>
-struct HashMapCT {
-  static constexpr uint32_t maxElements = N;
-  static constexpr float maxLoadFactor = 0.7f;
-  ArrayCT<HashEntry<KeyType, ValueType>, N> entries;
-  uint32_t count = 0;
-  Hash<KeyType> hasher;
+template <typename KeyType, typename ValueType, uint32_t N>
+struct MapCT {
+  ArrayCT<Entry<KeyType, ValueType>, N> entries;
 
-  HashMapCT() = default;
-  HashMapCT(const HashMapCT&) = delete;
-  HashMapCT& operator=(const HashMapCT&) = delete;
-  HashMapCT(HashMapCT&& other) = delete;
-  HashMapCT& operator=(HashMapCT&& other) = delete;
+  MapCT() = default;
+  MapCT(const MapCT&) = delete;
+  MapCT& operator=(const MapCT&) = delete;
+  MapCT(MapCT&& other) = delete;
+  MapCT& operator=(MapCT&& other) = delete;
 
   void init() {
-    entries.reserve_until(N);
     clear();
   }
 
-  uint32_t find_slot(const KeyType& key) const {
-    uint32_t hash = hasher(key);
-    uint32_t idx = hash % N;
-    uint32_t original = idx;
+  // Linear search to find an entry by key
+  uint32_t find(const KeyType& key) const {
+    Entry<KeyType, ValueType> temp{key, ValueType{}};
+    return entries.find(temp);
+  }
+
+  bool contains(const KeyType& key) const {
+    Entry<KeyType, ValueType> temp{key, ValueType{}};
+    return entries.contains(temp);
+  }
+
+  ValueType& get(const KeyType key) {
+    uint32_t idx = find(key);
+    if (idx == UINT32_MAX) {
+      idx = entries.add(Entry<KeyType, ValueType>{key, ValueType{}});
+    }
+    return entries[idx].value;
+  }
+
+  ValueType& operator[](const KeyType key) {
+    return get(key);
+  }
+
+  void remove(const KeyType& key) {
+    uint32_t idx = find(key);
+    if (idx != UINT32_MAX) {
+      entries.remove(idx);
+    }
+  }
+
+  void ordered_remove(const KeyType& key) {
+    uint32_t idx = find(key);
+    if (idx != UINT32_MAX) {
+      entries.ordered_remove(idx);
+    }
+  }
+
+  bool empty() const {
+    return entries.empty();
+  }
+
+  uint32_t size() const {
+    return entries.size();
+  }
+
+  uint32_t capacity() const {
+    return entries.capacity();
+  }
+
+  bool is_full() const {
+    return size() == capacity();
+  }
+
+  void clear() {
+    entries.clear();
+  }
+
+  using Iterator = MapIterator<KeyType, ValueType>;
+  Iterator begin() { return Iterator(entries.elements, entries.elements + entries.count); }
+  Iterator end() { return Iterator(entries.elements + entries.count, entries.elements + entries.count); }
+};
+
+template <typename KeyType, typename ValueType>
+struct MapRT {
+  ArrayRT<Entry<KeyType, ValueType>>* entries; // set when allocated
+
+  MapRT() = delete;
+  MapRT(const MapRT&) = delete;
+  MapRT& operator=(const MapRT&) = delete;
+  MapRT(MapRT&& other) = delete;
+  MapRT& operator=(MapRT&& other) = delete;
+
+  void init(ArrayRT<Entry<KeyType, ValueType>>& Aentries) {
+    entries = &Aentries;
+    clear();
+  }
+
+  // Linear search to find an entry by key
+  uint32_t find(const KeyType& key) const {
+    Entry<KeyType, ValueType> temp{key, ValueType{}};
+    return entries->find(temp);
+  }
+
+  bool contains(const KeyType& key) const {
+    Entry<KeyType, ValueType> temp{key, ValueType{}};
+    return entries->contains(temp);
+  }
+
+  ValueType& get(const KeyType key) {
+    uint32_t idx = find(key);
+    if (idx == UINT32_MAX) {
+      idx = entries->add(Entry<KeyType, ValueType>{key, ValueType{}});
+    }
+    return entries->get(idx).value;
+  }
+
+  ValueType& operator[](const KeyType key) {
+    return get(key);
+  }
+
+  void remove(const KeyType& key) {
+    uint32_t idx = find(key);
+    if (idx != UINT32_MAX) {
+      entries->remove(idx);
+    }
+  }
+
+  void ordered_remove(const KeyType& key) {
+    uint32_t idx = find(key);
+    if (idx != UINT32_MAX) {
+      entries->ordered_remove(idx);
+    }
+  }
+
+  bool empty() const {
+    return entries->empty();
+  }
+
+  uint32_t size() const {
+    return entries->size();
+  }
+
+  uint32_t capacity() const {
+    return entries->capacity();
+  }
+
+  bool is_full() const {
+    return size() == capacity();
+  }
+
+  void clear() {
+    entries->clear();
+  }
+
+  using Iterator = MapIterator<KeyType, ValueType>;
+  Iterator begin() { return Iterator(entries->elements, entries->elements + entries->count); }
+  Iterator end() { return Iterator(entries->elements + entries->count, entries->elements + entries->count); }
+};
+
+// NOTE: Hashing
+
+// wyhash (final v4), reads 8 bytes at a time & folds with a 64x64->128 multiply
+struct WyHash {
+  static constexpr uint64_t secret[4] = {
+    0xa0761d6478bd642fULL, 0xe7037ed1a0b428dbULL, 0x8ebc6af09c88c6e3ULL, 0x589965cc75374cc3ULL
+  };
+
+  static void mum(uint64_t* a, uint64_t* b) { // a, b = low & high half of a * b
+#if defined(_MSC_VER) && defined(_M_X64)
+    *a = _umul128(*a, *b, b);
+#else
+    __extension__ typedef unsigned __int128 uint128;
+    uint128 r = (uint128)*a * *b;
+    *a = (uint64_t)r;
+    *b = (uint64_t)(r >> 64);
+#endif
+  }
+
+  static uint64_t mix(uint64_t a, uint64_t b) {
+    mum(&a, &b);
+    return a ^ b;
+  }
+
+  static uint64_t read8(const uint8_t* p) { uint64_t v; memcpy(&v, p, 8); return v; }
+  static uint64_t read4(const uint8_t* p) { uint32_t v; memcpy(&v, p, 4); return v; }
+  static uint64_t read3(const uint8_t* p, size_t k) {
+    return ((uint64_t)p[0] << 16) | ((uint64_t)p[k >> 1] << 8) | p[k - 1];
+  }
+};
+
+inline uint64_t hash_bytes(const void* key, size_t len, uint64_t seed = 0) {
+  const uint64_t* s = WyHash::secret;
+  const uint8_t* p = (const uint8_t*)key;
+  seed ^= WyHash::mix(seed ^ s[0], s[1]);
+  uint64_t a, b;
+
+  if (len <= 16) {
+    if (len >= 4) {
+      a = (WyHash::read4(p) << 32) | WyHash::read4(p + ((len >> 3) << 2));
+      b = (WyHash::read4(p + len - 4) << 32) | WyHash::read4(p + len - 4 - ((len >> 3) << 2));
+    } else if (len > 0) {
+      a = WyHash::read3(p, len);
+      b = 0;
+    } else {
+      a = b = 0;
+    }
+  } else {
+    size_t i = len;
+    if (i > 48) {
+      uint64_t see1 = seed, see2 = seed;
+      do {
+        seed = WyHash::mix(WyHash::read8(p) ^ s[1], WyHash::read8(p + 8) ^ seed);
+        see1 = WyHash::mix(WyHash::read8(p + 16) ^ s[2], WyHash::read8(p + 24) ^ see1);
+        see2 = WyHash::mix(WyHash::read8(p + 32) ^ s[3], WyHash::read8(p + 40) ^ see2);
+        p += 48;
+        i -= 48;
+      } while (i > 48);
+      seed ^= see1 ^ see2;
+    }
+    while (i > 16) {
+      seed = WyHash::mix(WyHash::read8(p) ^ s[1], WyHash::read8(p + 8) ^ seed);
+      i -= 16;
+      p += 16;
+    }
+    a = WyHash::read8(p + i - 16);
+    b = WyHash::read8(p + i - 8);
+  }
+
+  a ^= s[1];
+  b ^= seed;
+  WyHash::mum(&a, &b);
+  return WyHash::mix(a ^ s[0] ^ len, b ^ s[1]);
+}
+
+inline uint64_t hash_u64(uint64_t key) {
+  return WyHash::mix(key ^ WyHash::secret[0], WyHash::secret[1]);
+}
+
+inline uint64_t hash_string(const char* key) {
+  return hash_bytes(key, strlen(key));
+}
+
+// Order dependent, hash_combine(a, b) != hash_combine(b, a)
+inline uint64_t hash_combine(uint64_t seed, uint64_t hash) {
+  return WyHash::mix(seed ^ WyHash::secret[2], hash ^ WyHash::secret[3]);
+}
+
+// Integers, enums & padding free PODs hash out of the box, anything else needs a specialization
+template<typename T>
+struct Hash {
+  static_assert(std::is_enum_v<T> || std::has_unique_object_representations_v<T>,
+                "Hash<T> can't hash this type by its bytes (padding or floats), specialize Hash<T>");
+
+  uint64_t operator()(const T& key) const {
+    if constexpr (std::is_enum_v<T>) {
+      return hash_u64((uint64_t)(std::underlying_type_t<T>)key);
+    } else if constexpr (std::is_integral_v<T> && sizeof(T) <= sizeof(uint64_t)) {
+      return hash_u64((uint64_t)key);
+    } else {
+      return hash_bytes(&key, sizeof(T));
+    }
+  }
+};
+
+template<>
+struct Hash<const char*> {
+  uint64_t operator()(const char* key) const {
+    return hash_string(key);
+  }
+};
+
+template<>
+struct Hash<char*> {
+  uint64_t operator()(const char* key) const {
+    return hash_string(key);
+  }
+};
+
+// NOTE: Hashmap
+
+// Control bytes live in their own array, one per slot, so a probe can test 16
+// slots with a single SSE2 compare. A full slot stores the low 7 bits of its
+// hash (H2), the remaining bits (H1) pick the group the probe starts at.
+struct HashCtrl {
+  static constexpr int8_t Empty = -128; // 0b10000000
+  static constexpr int8_t Dead = -2;    // 0b11111110
+  static constexpr uint32_t groupWidth = 16;
+
+  static constexpr uint32_t slot_count(uint32_t maxElements) { // Power of two, at least one group
+    uint32_t slots = groupWidth;
+    while (slots < maxElements) slots <<= 1;
+    return slots;
+  }
+
+  static uint32_t h1(uint64_t hash) { return (uint32_t)(hash >> 7); }
+  static int8_t h2(uint64_t hash) { return (int8_t)(hash & 0x7F); }
+};
+
+inline uint32_t count_trailing_zeros(uint32_t x) {
+#ifdef _MSC_VER
+  unsigned long idx;
+  _BitScanForward(&idx, x);
+  return idx;
+#else
+  return __builtin_ctz(x);
+#endif
+}
+
+// Bitmask of the slots in one group that matched, bit i == slot i of the group
+struct HashGroup {
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+  __m128i ctrl;
+
+  explicit HashGroup(const int8_t* pos) : ctrl(_mm_loadu_si128((const __m128i*)pos)) {}
+
+  uint32_t match(int8_t h2) const {
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl));
+  }
+
+  uint32_t match_empty() const {
+    return match(HashCtrl::Empty);
+  }
+
+  uint32_t match_empty_or_dead() const { // Only Empty & Dead have the sign bit set
+    return (uint32_t)_mm_movemask_epi8(ctrl);
+  }
+#else
+  const int8_t* ctrl;
+
+  explicit HashGroup(const int8_t* pos) : ctrl(pos) {}
+
+  uint32_t match(int8_t h2) const {
+    uint32_t mask = 0;
+    for (uint32_t i = 0; i < HashCtrl::groupWidth; i++) {
+      mask |= (uint32_t)(ctrl[i] == h2) << i;
+    }
+    return mask;
+  }
+
+  uint32_t match_empty() const {
+    return match(HashCtrl::Empty);
+  }
+
+  uint32_t match_empty_or_dead() const {
+    uint32_t mask = 0;
+    for (uint32_t i = 0; i < HashCtrl::groupWidth; i++) {
+      mask |= (uint32_t)(ctrl[i] < 0) << i;
+    }
+    return mask;
+  }
+#endif
+};
+
+template<typename K, typename V>
+struct HashEntry {
+  K key;
+  V value;
+  uint64_t hash; // Full hash, compared before the key so tag collisions skip KeyCompare
+
+  bool operator==(const HashEntry& other) const {
+    return KeyCompare<K>::equals(key, other.key);
+  }
+};
+
+template<typename K, typename V>
+struct HashMapIterator {
+  HashEntry<K,V>* entries;
+  const int8_t* ctrl;
+  uint32_t idx;
+  uint32_t end;
+
+  HashMapIterator(const HashMapIterator&) = delete;
+  HashMapIterator& operator=(const HashMapIterator&) = delete;
+  HashMapIterator(HashMapIterator&& other) = delete;
+  HashMapIterator& operator=(HashMapIterator&& other) = delete;
+
+  HashMapIterator(HashEntry<K,V>* entries, const int8_t* ctrl, uint32_t start, uint32_t end) 
+      : entries(entries), ctrl(ctrl), idx(start), end(end) {
+    // Find first occupied entry
+    while (idx != end && ctrl[idx] < 0) {
+      ++idx;
+    }
+  }
+
+  HashMapIterator& operator++() {
+    if (idx != end) {
+      ++idx;
+      // Skip to next occupied entry
+      while (idx != end && ctrl[idx] < 0) {
+        ++idx;
+      }
+    }
+    return *this;
+  }
+
+  bool operator!=(const HashMapIterator& other) const { return idx != other.idx; }
+  HashEntry<K,V>& operator*() const { return entries[idx]; }
+  HashEntry<K,V>* operator->() const { return &entries[idx]; }
+
+  K& key() const { return entries[idx].key; }
+  V& value() const { return entries[idx].value; }
+};
+
+template<typename KeyType, typename ValueType, uint32_t N>
+struct HashMapCT {
+  static constexpr uint32_t maxElements = N;
+  static constexpr uint32_t slotCount = HashCtrl::slot_count(N);
+  static constexpr uint32_t groupMask = slotCount / HashCtrl::groupWidth - 1;
+  static constexpr float maxLoadFactor = 0.7f;
+  int8_t ctrl[slotCount];
+  HashEntry<KeyType, ValueType> entries[slotCount];
+  uint32_t count = 0;
+  uint32_t dead = 0; // Tombstones, reclaimed by insert_slot or purge_dead
+  Hash<KeyType> hasher;
+
+  HashMapCT() = default;
+  HashMapCT(const HashMapCT&) = delete;
+  HashMapCT& operator=(const HashMapCT&) = delete;
+  HashMapCT(HashMapCT&& other) = delete;
+  HashMapCT& operator=(HashMapCT&& other) = delete;
+
+  void init() {
+    clear();
+  }
+
+  // Triangular probing over groups, visits every group once as groupMask + 1 is a power of two
+  uint32_t find_slot(const KeyType& key, uint64_t hash) const {
+    int8_t h2 = HashCtrl::h2(hash);
+    uint32_t group = HashCtrl::h1(hash) & groupMask;
+
+    for (uint32_t step = 1; step <= groupMask + 1; step++) {
+      uint32_t base = group * HashCtrl::groupWidth;
+      HashGroup g(ctrl + base);
+      for (uint32_t match = g.match(h2); match; match &= match - 1) {
+        uint32_t idx = base + count_trailing_zeros(match);
+        if (entries[idx].hash == hash && KeyCompare<KeyType>::equals(entries[idx].key, key)) {
+          return idx;
+        }
+      }
+      if (g.match_empty()) return UINT32_MAX;
+      group = (group + step) & groupMask;
+    }
+
+    return UINT32_MAX;
+  }
+
+  uint32_t find_slot(const KeyType& key) const {
+    return find_slot(key, hasher(key));
+  }
+
+  uint32_t find_empty_slot(uint64_t hash) {
+    uint32_t group = HashCtrl::h1(hash) & groupMask;
+
+    for (uint32_t step = 1; step <= groupMask + 1; step++) {
+      uint32_t base = group * HashCtrl::groupWidth;
+      uint32_t match = HashGroup(ctrl + base).match_empty_or_dead();
+      if (match) return base + count_trailing_zeros(match);
+      group = (group + step) & groupMask;
+    }
+
+    LOG_ASSERT(false, "No empty slots!");
+    return UINT32_MAX;
+  }
+
+  // Claims the first free slot on the probe sequence, key must not be present
+  uint32_t insert_slot(uint64_t hash) {
+    uint32_t idx = find_empty_slot(hash);
+    if (ctrl[idx] == HashCtrl::Dead) dead--;
+    ctrl[idx] = HashCtrl::h2(hash);
+    entries[idx].hash = hash;
+    count++;
+    return idx;
+  }
+
+  void erase_slot(uint32_t idx) {
+    // A group that still has an empty slot was never full, so no probe went past it
+    uint32_t base = idx & ~(HashCtrl::groupWidth - 1);
+    if (HashGroup(ctrl + base).match_empty()) {
+      ctrl[idx] = HashCtrl::Empty;
+    } else {
+      ctrl[idx] = HashCtrl::Dead;
+      dead++;
+    }
+    count--;
+  }
+
+  ValueType& get(const KeyType& key) {
+    uint64_t hash = hasher(key);
+    uint32_t idx = find_slot(key, hash);
+    if (idx == UINT32_MAX) {
+      LOG_ASSERT(count < N * maxLoadFactor, "HashMap too full!");
+      idx = insert_slot(hash);
+      entries[idx].key = key;
+      entries[idx].value = ValueType{};
+    }
+    return entries[idx].value;
+  }
+
+  ValueType& operator[](const KeyType& key) {
+    return get(key);
+  }
+
+  void remove(const KeyType& key) {
+    uint32_t idx = find_slot(key);
+    if (idx != UINT32_MAX) {
+      erase_slot(idx);
+    }
+  }
+
+  // Rehash in place so every tombstone becomes an empty slot again, no extra memory needed
+  void purge_dead() {
+    HashEntry<KeyType, ValueType>* slots = entries;
+
+    // Tombstones become Empty, live slots become Dead meaning "not placed yet"
+    for (uint32_t i = 0; i < slotCount; i++) {
+      ctrl[i] = ctrl[i] < 0 ? HashCtrl::Empty : HashCtrl::Dead;
+    }
+
+    for (uint32_t i = 0; i < slotCount; i++) {
+      if (ctrl[i] != HashCtrl::Dead) continue;
+      uint64_t hash = slots[i].hash;
+      uint32_t target = find_empty_slot(hash);
+
+      if (target / HashCtrl::groupWidth == i / HashCtrl::groupWidth) { // Already in its first free group
+        ctrl[i] = HashCtrl::h2(hash);
+      } else if (ctrl[target] == HashCtrl::Empty) {
+        slots[target] = slots[i];
+        ctrl[target] = HashCtrl::h2(hash);
+        ctrl[i] = HashCtrl::Empty;
+      } else { // Target still holds an unplaced entry, swap and place that one next
+        swap(slots[i], slots[target]);
+        ctrl[target] = HashCtrl::h2(hash);
+        i--;
+      }
+    }
+    dead = 0;
+  }
+
+  bool contains(const KeyType& key) const {
+    return find_slot(key) != UINT32_MAX;
+  }
+
+  uint32_t size() const { return count; }
+
+  bool empty() const { return count == 0; }
+
+  void clear() {
+    memset(ctrl, HashCtrl::Empty, sizeof(ctrl));
+    count = 0;
+    dead = 0;
+  }
+
+  uint32_t capacity() const { return maxElements; }
+
+  bool is_full() const { return size() == capacity(); }
+
+  using Iterator = HashMapIterator<KeyType, ValueType>;
+  Iterator begin() { 
+    return Iterator(entries, ctrl, 0, slotCount); 
+  }
+  Iterator end() { 
+    return Iterator(entries, ctrl, slotCount, slotCount); 
+  }
+};
+
+template<typename KeyType, typename ValueType>
+struct HashMapRT {
+  ArrayRT<HashEntry<KeyType, ValueType>>* entries; // Set at runtime
+  int8_t* ctrl; // Set at runtime
+  uint32_t maxElements; // Set at runtime
+  uint32_t slotCount; // Set at runtime
+  uint32_t groupMask; // Set at runtime
+  uint32_t count = 0;
+  uint32_t dead = 0; // Tombstones, reclaimed by insert_slot or purge_dead
+  static constexpr float maxLoadFactor = 0.7f;
+  Hash<KeyType> hasher;
+
+  HashMapRT() = delete;
+  HashMapRT(const HashMapRT&) = delete;
+  HashMapRT& operator=(const HashMapRT&) = delete;
+  HashMapRT(HashMapRT&& other) = delete;
+  HashMapRT& operator=(HashMapRT&& other) = delete;
+
+  // Aentries & Actrl must hold HashCtrl::slot_count(AmaxElements) slots
+  void init(ArrayRT<HashEntry<KeyType, ValueType>>& Aentries, int8_t* Actrl, uint32_t AmaxElements) {
+    slotCount = HashCtrl::slot_count(AmaxElements);
+    Aentries.reserve_until(slotCount);
+    entries = &Aentries;
+    ctrl = Actrl;
+    maxElements = AmaxElements;
+    groupMask = slotCount / HashCtrl::groupWidth - 1;
+    clear();
+  }
+
+  // Triangular probing over groups, visits every group once as groupMask + 1 is a power of two
+  uint32_t find_slot(const KeyType& key, uint64_t hash) const {
+    int8_t h2 = HashCtrl::h2(hash);
+    uint32_t group = HashCtrl::h1(hash) & groupMask;
+    const HashEntry<KeyType, ValueType>* slots = entries->elements;
+
+    for (uint32_t step = 1; step <= groupMask + 1; step++) {
+      uint32_t base = group * HashCtrl::groupWidth;
+      HashGroup g(ctrl + base);
+      for (uint32_t match = g.match(h2); match; match &= match - 1) {
+        uint32_t idx = base + count_trailing_zeros(match);
+        if (slots[idx].hash == hash && KeyCompare<KeyType>::equals(slots[idx].key, key)) {
+          return idx;
+        }
+      }
+      if (g.match_empty()) return UINT32_MAX;
+      group = (group + step) & groupMask;
+    }
+
+    return UINT32_MAX;
+  }
+
+  uint32_t find_slot(const KeyType& key) const {
+    return find_slot(key, hasher(key));
+  }
+
+  uint32_t find_empty_slot(uint64_t hash) {
+    uint32_t group = HashCtrl::h1(hash) & groupMask;
+
+    for (uint32_t step = 1; step <= groupMask + 1; step++) {
+      uint32_t base = group * HashCtrl::groupWidth;
+      uint32_t match = HashGroup(ctrl + base).match_empty_or_dead();
+      if (match) return base + count_trailing_zeros(match);
+      group = (group + step) & groupMask;
+    }
+
+    LOG_ASSERT(false, "No empty slots!");
+    return UINT32_MAX;
+  }
+
+  // Claims the first free slot on the probe sequence, key must not be present
+  uint32_t insert_slot(uint64_t hash) {
+    uint32_t idx = find_empty_slot(hash);
+    if (ctrl[idx] == HashCtrl::Dead) dead--;
+    ctrl[idx] = HashCtrl::h2(hash);
+    entries->elements[idx].hash = hash;
+    count++;
+    return idx;
+  }
+
+  void erase_slot(uint32_t idx) {
+    // A group that still has an empty slot was never full, so no probe went past it
+    uint32_t base = idx & ~(HashCtrl::groupWidth - 1);
+    if (HashGroup(ctrl + base).match_empty()) {
+      ctrl[idx] = HashCtrl::Empty;
+    } else {
+      ctrl[idx] = HashCtrl::Dead;
+      dead++;
+    }
+    count--;
+  }
+
+  ValueType& get(const KeyType& key) {
+    uint64_t hash = hasher(key);
+    uint32_t idx = find_slot(key, hash);
+    if (idx == UINT32_MAX) {
+      LOG_ASSERT(count < maxElements * maxLoadFactor, "HashMap too full!");
+      idx = insert_slot(hash);
+      entries->elements[idx].key = key;
+      entries->elements[idx].value = ValueType{};
+    }
+    return entries->elements[idx].value;
+  }
+
+  ValueType& operator[](const KeyType& key) {
+    return get(key);
+  }
+
+  void remove(const KeyType& key) {
+    uint32_t idx = find_slot(key);
+    if (idx != UINT32_MAX) {
+      erase_slot(idx);
+    }
+  }
+
+  // Rehash in place so every tombstone becomes an empty slot again, no extra memory needed
+  void purge_dead() {
+    HashEntry<KeyType, ValueType>* slots = entries->elements;
+
+    // Tombstones become Empty, live slots become Dead meaning "not placed yet"
+    for (uint32_t i = 0; i < slotCount; i++) {
+      ctrl[i] = ctrl[i] < 0 ? HashCtrl::Empty : HashCtrl::Dead;
+    }
+
+    for (uint32_t i = 0; i < slotCount; i++) {
+      if (ctrl[i] != HashCtrl::Dead) continue;
+      uint64_t hash = slots[i].hash;
+      uint32_t target = find_empty_slot(hash);
+
+      if (target / HashCtrl::groupWidth == i / HashCtrl::groupWidth) { // Already in its first free group
+        ctrl[i] = HashCtrl::h2(hash);
+      } else if (ctrl[target] == HashCtrl::Empty) {
+        slots[target] = slots[i];
+        ctrl[target] = HashCtrl::h2(hash);
+        ctrl[i] = HashCtrl::Empty;
+      } else { // Target still holds an unplaced entry, swap and place that one next
+        swap(slots[i], slots[target]);
+        ctrl[target] = HashCtrl::h2(hash);
+        i--;
+      }
+    }
+    dead = 0;
+  }
+
+  bool contains(const KeyType& key) const {
+    return find_slot(key) != UINT32_MAX;
+  }
+
+  uint32_t size() const { return count; }
+
+  bool empty() const { return count == 0; }
+
+  void clear() {
+    memset(ctrl, HashCtrl::Empty, slotCount);
+    count = 0;
+    dead = 0;
+  }
+
+  uint32_t capacity() const { return maxElements; }
+
+  bool is_full() const { return size() == capacity(); }
+
+  using Iterator = HashMapIterator<KeyType, ValueType>;
+  Iterator begin() { 
+    return Iterator(entries->elements, ctrl, 0, slotCount); 
+  }
+  Iterator end() { 
+    return Iterator(entries->elements, ctrl, slotCount, slotCount); 
+  }
+};
+
+class Arena;
+
+// Runtime hashmap that grows inside its arena. Growing allocates a table twice the size
+// and entries move over a few groups per operation, so there is no stop-the-world rehash.
+// The old table's memory is only reclaimed when the arena is cleared.
+template<typename KeyType, typename ValueType>
+struct GrowableHashMapRT {
+  static constexpr uint32_t migrateGroupsPerOp = 2;
+  static constexpr float maxDeadFactor = 0.2f; // Purge tombstones in place past this
+  Arena* arena; // Set at runtime
+  HashMapRT<KeyType, ValueType>* table; // Set at runtime
+  HashMapRT<KeyType, ValueType>* old; // Table being migrated from, nullptr when done
+  uint32_t migrateCursor;
+  Hash<KeyType> hasher;
+
+  GrowableHashMapRT() = delete;
+  GrowableHashMapRT(const GrowableHashMapRT&) = delete;
+  GrowableHashMapRT& operator=(const GrowableHashMapRT&) = delete;
+  GrowableHashMapRT(GrowableHashMapRT&& other) = delete;
+  GrowableHashMapRT& operator=(GrowableHashMapRT&& other) = delete;
+
+  void init(Arena& Aarena, HashMapRT<KeyType, ValueType>& Atable) {
+    arena = &Aarena;
+    table = &Atable;
+    old = nullptr;
+    migrateCursor = 0;
+  }
+
+  uint32_t move_from_old(uint32_t oldIdx) {
+    HashEntry<KeyType, ValueType>& entry = old->entries->elements[oldIdx];
+    uint32_t idx = table->insert_slot(entry.hash);
+    table->entries->elements[idx] = entry;
+    old->erase_slot(oldIdx);
+    return idx;
+  }
+
+  void migrate(uint32_t groups) {
+    if (!old) return;
+    uint32_t stop = migrateCursor + groups * HashCtrl::groupWidth;
+    if (stop > old->slotCount) stop = old->slotCount;
+    for (; migrateCursor < stop; migrateCursor++) {
+      if (old->ctrl[migrateCursor] >= 0) move_from_old(migrateCursor);
+    }
+    if (migrateCursor == old->slotCount) old = nullptr;
+  }
+
+  void grow(); // Defined after Arena
+
+  void make_room() {
+    uint32_t limit = (uint32_t)(table->slotCount * HashMapRT<KeyType, ValueType>::maxLoadFactor);
+    if (size() + table->dead < limit) return;
+
+    if (old) migrate(old->slotCount / HashCtrl::groupWidth); // Only if inserts outpace migration
+    if (table->count < limit / 2) {
+      table->purge_dead(); // Mostly tombstones, rehashing in place frees enough room
+    } else {
+      grow();
+    }
+  }
+
+  // Returned references are valid until the next get or remove, entries move while migrating
+  ValueType& get(const KeyType& key) {
+    migrate(migrateGroupsPerOp);
+    uint64_t hash = hasher(key);
+    uint32_t idx = table->find_slot(key, hash);
+    if (idx != UINT32_MAX) return table->entries->elements[idx].value;
+
+    if (old) {
+      uint32_t oldIdx = old->find_slot(key, hash);
+      if (oldIdx != UINT32_MAX) return table->entries->elements[move_from_old(oldIdx)].value;
+    }
+
+    make_room();
+    idx = table->insert_slot(hash);
+    table->entries->elements[idx].key = key;
+    table->entries->elements[idx].value = ValueType{};
+    return table->entries->elements[idx].value;
+  }
+
+  ValueType& operator[](const KeyType& key) {
+    return get(key);
+  }
+
+  void remove(const KeyType& key) {
+    migrate(migrateGroupsPerOp);
+    uint64_t hash = hasher(key);
+    uint32_t idx = table->find_slot(key, hash);
+    if (idx != UINT32_MAX) {
+      table->erase_slot(idx);
+    } else if (old) {
+      uint32_t oldIdx = old->find_slot(key, hash);
+      if (oldIdx != UINT32_MAX) old->erase_slot(oldIdx);
+    }
+
+    if (!old && table->dead > table->slotCount * maxDeadFactor) {
+      table->purge_dead();
+    }
+  }
+
+  bool contains(const KeyType& key) const {
+    uint64_t hash = hasher(key);
+    if (table->find_slot(key, hash) != UINT32_MAX) return true;
+    return old && old->find_slot(key, hash) != UINT32_MAX;
+  }
+
+  uint32_t size() const { return table->count + (old ? old->count : 0); }
+
+  bool empty() const { return size() == 0; }
+
+  bool is_migrating() const { return old != nullptr; }
+
+  void clear() { // Keeps the current table size
+    table->clear();
+    old = nullptr;
+    migrateCursor = 0;
+  }
+
+  uint32_t capacity() const { return table->capacity(); }
+
+  struct Iterator {
+    HashMapRT<KeyType, ValueType>* tables[2]; // [current, old]
+    uint32_t tableIdx;
+    uint32_t idx;
+
+    Iterator(const Iterator&) = delete;
+    Iterator& operator=(const Iterator&) = delete;
+    Iterator(Iterator&& other) = delete;
+    Iterator& operator=(Iterator&& other) = delete;
+
+    Iterator(HashMapRT<KeyType, ValueType>* current, HashMapRT<KeyType, ValueType>* old, uint32_t AtableIdx)
+        : tables{current, old}, tableIdx(AtableIdx), idx(0) {
+      skip();
+    }
+
+    void skip() { // Find next occupied entry, moving on to the old table when needed
+      for (; tableIdx < 2; tableIdx++, idx = 0) {
+        HashMapRT<KeyType, ValueType>* t = tables[tableIdx];
+        if (!t) continue;
+        while (idx < t->slotCount && t->ctrl[idx] < 0) idx++;
+        if (idx < t->slotCount) return;
+      }
+    }
+
+    Iterator& operator++() {
+      if (tableIdx < 2) {
+        ++idx;
+        skip();
+      }
+      return *this;
+    }
+
+    bool operator!=(const Iterator& other) const { return tableIdx != other.tableIdx || idx != other.idx; }
+    HashEntry<KeyType, ValueType>& operator*() const { return tables[tableIdx]->entries->elements[idx]; }
+    HashEntry<KeyType, ValueType>* operator->() const { return &tables[tableIdx]->entries->elements[idx]; }
+
+    KeyType& key() const { return tables[tableIdx]->entries->elements[idx].key; }
+    ValueType& value() const { return tables[tableIdx]->entries->elements[idx].value; }
+  };
+
+  Iterator begin() { return Iterator(table, old, 0); }
+  Iterator end() { return Iterator(table, old, 2); }
+};
+
+// NOTE: Generational Sparse set
+
+struct GenId {
+  static constexpr uint32_t GEN_BITS = 8;
+  static constexpr uint32_t ID_BITS = 24;
+  static constexpr uint32_t ID_MASK = (1u << ID_BITS) - 1;
+  static constexpr uint32_t GEN_MASK = ((1u << GEN_BITS) - 1) << ID_BITS;
+
+  uint32_t packed;
+
+  bool operator==(const GenId& other) const {
+    return packed == other.packed;
+  }
+
+  bool operator!=(const GenId& other) const {
+    return !(*this==other);
+  }
+
+  static GenId create(uint32_t id, uint8_t gen) {
+    LOG_ASSERT(id < (1u << ID_BITS), "ID exceeds 24 bits");
+    return GenId{(gen << ID_BITS) | id};
+  }
+
+  void set_id(uint32_t id) {
+    LOG_ASSERT(id < (1u << ID_BITS), "ID exceeds 24 bits");
+    packed = (packed & ~ID_MASK) | id;
+  }
+
+  void set_gen(uint8_t gen) {
+    packed = (packed & ID_MASK) | (gen << ID_BITS);
+  }
+
+  void increment_gen() {
+    uint8_t next_gen = (gen() + 1) & ((1 << GEN_BITS) - 1);
+    set_gen(next_gen);
+  }
+
+  uint32_t id() const { return packed & ID_MASK; }
+
+  uint8_t gen() const { return (packed >> ID_BITS) & ((1u << GEN_BITS) - 1); }
+};
+
+template<>
+struct Hash<GenId> {
+  uint64_t operator()(const GenId& key) const {
+    return hash_u64(key.packed);
+  }
+};
+
+template<typename T, uint32_t N>
+struct GenSparseSetCT {
+  ArrayCT<T, N> dense;
+  ArrayCT<GenId, N> sparse;
+  ArrayCT<uint32_t, N> dense_to_sparse;
+  uint32_t free_head;
+
+  void init() {
+    sparse.reserve_until(N);
+    for (uint32_t i = 0; i < N-1; i++) {
+      auto& entry = sparse[i];
+      entry.set_id(i + 1);
+      entry.set_gen(0);
+    }
+    auto& last = sparse[N-1];
+    last.set_id(N);
+    last.set_gen(0);
+    free_head = 0;
+  }
+
+  GenId add(const T& val) {
+    auto& entry = sparse[free_head];
+    uint32_t next_free = entry.id();
+    uint32_t dense_idx = dense.size();
+
+    dense.add(val);
+    dense_to_sparse.add(free_head);
+    entry.set_id(dense_idx);
+
+    GenId res = GenId::create(free_head, entry.gen());
+    free_head = next_free;
+
+    return res;
+  }
+
+  void remove(GenId genId) {
+    if (genId.id() >= N) return;
+
+    auto& entry = sparse[genId.id()];
+    if (entry.gen() != genId.gen()) return;
+    uint32_t prev_back = dense_to_sparse.back();
+
+    dense.remove(entry.id());
+    dense_to_sparse.remove(entry.id());
+    sparse[prev_back].set_id(entry.id());
+
+    entry.set_id(free_head);
+    entry.increment_gen();
+    free_head = genId.id();
+  }
+
+  T* get(GenId genId) {
+    if (genId.id() >= N) return nullptr;
+    const auto& entry = sparse[genId.id()];
+    if (entry.id() >= dense.size()) return nullptr;
+    if (entry.gen() != genId.gen()) return nullptr;
+    return &dense[entry.id()];
+  }
+
+  T* operator[](GenId genId) {
+    return get(genId);
+  }
+
+  GenId find(const T& value) const {
+    for (uint32_t i = 0; i < dense.size(); i++) {
+      if (dense[i] == value) {
+        uint32_t sparse_idx = dense_to_sparse[i];
+        return GenId::create(sparse_idx, sparse[sparse_idx].gen());
+      }
+    }
+    return {UINT32_MAX};
+  }
+
+  bool contains(GenId genId) const {
+    if (genId.id() >= sparse.size()) return false;
+    const auto& entry = sparse[genId.id()];
+    if (entry.id() >= dense.size()) return false;
+    return entry.gen() == genId.gen();
+  }
+
+  void clear() {
+    dense.clear();
+    dense_to_sparse.clear();
+
+    // Rebuild free list while preserving generations
+    for (uint32_t i = 0; i < N-1; i++) {
+      auto& entry = sparse[i];
+      entry.increment_gen();
+      entry.set_id(i + 1);
+    }
+
+    auto& last = sparse[N-1];
+    last.increment_gen();
+    last.set_id(N);
+
+    free_head = 0;
+  }
+
+  uint32_t size() const { return dense.size(); }
+
+  bool empty() const { return dense.empty(); }
+
+  bool is_full() const { return dense.size() == dense.capacity(); }
+
+  bool capacity() const { return dense.capacity(); }
+
+  using Iterator = typename ArrayCT<T, N>::Iterator;
+  Iterator begin() { return dense.begin(); }
+  Iterator end() { return dense.end(); }
+};
+
+template<typename T>
+struct GenSparseSetRT {
+  uint32_t N; // Set at runtime
+  ArrayRT<T>* dense; // Set at runtime
+  ArrayRT<GenId>* sparse; // Set at runtime
+  ArrayRT<uint32_t>* dense_to_sparse; // Set at runtime
+  uint32_t free_head;
+
+  void init(uint32_t _N, ArrayRT<T>& _dense, ArrayRT<GenId>& _sparse, ArrayRT<uint32_t>& _dense_to_sparse) {
+    N = _N;
+    dense = &_dense;
+    sparse = &_sparse;
+    dense_to_sparse = &_dense_to_sparse;
+
+    sparse->reserve_until(N);
+    for (uint32_t i = 0; i < N-1; i++) {
+      auto& entry = sparse->get(i);
+      entry.set_id(i + 1);
+      entry.set_gen(0);
+    }
+    auto& last = sparse->get(N-1);
+    last.set_id(N);
+    last.set_gen(0);
+    free_head = 0;
+  }
+
+  GenId add(const T& val) {
+    auto& entry = sparse->get(free_head);
+    uint32_t next_free = entry.id();
+    uint32_t dense_idx = dense->size();
+
+    dense->add(val);
+    dense_to_sparse->add(free_head);
+    entry.set_id(dense_idx);
+
+    GenId res = GenId::create(free_head, entry.gen());
+    free_head = next_free;
+
+    return res;
+  }
+
+  void remove(GenId genId) {
+    if (genId.id() >= N) return;
+
+    auto& entry = sparse->get(genId.id());
+    if (entry.gen() != genId.gen()) return;
+    uint32_t prev_back = dense_to_sparse->back();
+
+    dense->remove(entry.id());
+    dense_to_sparse->remove(entry.id());
+    sparse->get(prev_back).set_id(entry.id());
+
+    entry.set_id(free_head);
+    entry.increment_gen();
+    free_head = genId.id();
+  }
+
+  T* get(GenId genId) {
+    if (genId.id() >= N) return nullptr;
+    const auto& entry = sparse->get(genId.id());
+    if (entry.id() >= dense->size()) return nullptr;
+    if (entry.gen() != genId.gen()) return nullptr;
+    return &dense->get(entry.id());
+  }
+
+  T* operator[](GenId genId) {
+    return get(genId);
+  }
+
+  GenId find(const T& value) const {
+    for (uint32_t i = 0; i < dense->size(); i++) {
+      if (dense->get(i) == value) {
+        uint32_t sparse_idx = dense_to_sparse->get(i);
+        return GenId::create(sparse_idx, sparse->get(sparse_idx).gen());
+      }
+    }
+    return {UINT32_MAX};
+  }
+
+  bool contains(GenId genId) const {
+    if (genId.id() >= sparse->size()) return false;
+    const auto& entry = sparse->get(genId.id());
+    if (entry.id() >= dense->size()) return false;
+    return entry.gen() == genId.gen();
+  }
+
+  void clear() {
+    dense->clear();
+    dense_to_sparse->clear();
+
+    // Rebuild free list while preserving generations
+    for (uint32_t i = 0; i < N-1; i++) {
+      auto& entry = sparse->get(i);
+      entry.increment_gen();
+      entry.set_id(i + 1);
+    }
+
+    auto& last = sparse->get(N-1);
+    last.increment_gen();
+    last.set_id(N);
+
+    free_head = 0;
+  }
+
+  uint32_t size() const { return dense->size(); }
+
+  bool empty() const { return dense->empty(); }
+
+  bool is_full() const { return dense->size() == dense->capacity(); }
+
+  bool capacity() const { return dense->capacity(); }
+
+  using Iterator = typename ArrayRT<T>::Iterator;
+  Iterator begin() { return dense->begin(); }
+  Iterator end() { return dense->end(); }
+};
+
+// Handle with a configurable id/generation split, e.g. GenHandle<20, 12> or a 64 bit GenHandle<32, 32>
+template<uint32_t IdBits, uint32_t GenBits>
+struct GenHandle {
+  static_assert(IdBits > 0 && IdBits <= 32 && GenBits > 0 && GenBits <= 32, "Id & generation bits must be 1..32");
+  using Storage = std::conditional_t<IdBits + GenBits <= 32, uint32_t, uint64_t>;
+  static constexpr uint32_t ID_BITS = IdBits;
+  static constexpr uint32_t GEN_BITS = GenBits;
+  static constexpr Storage ID_MASK = (Storage)(((uint64_t)1 << IdBits) - 1);
+  static constexpr uint32_t MAX_GEN = (uint32_t)(((uint64_t)1 << GenBits) - 1);
+  static constexpr uint32_t MAX_IDS = (uint32_t)ID_MASK; // All ones id is reserved for null()
+
+  Storage packed;
+
+  bool operator==(const GenHandle& other) const {
+    return packed == other.packed;
+  }
+
+  bool operator!=(const GenHandle& other) const {
+    return !(*this==other);
+  }
+
+  static GenHandle create(uint32_t id, uint32_t gen) {
+    LOG_ASSERT(id <= ID_MASK && gen <= MAX_GEN, "ID or generation exceeds its bits");
+    return GenHandle{(Storage)(((Storage)gen << IdBits) | id)};
+  }
+
+  static GenHandle null() {
+    return GenHandle{(Storage)~(Storage)0};
+  }
+
+  uint32_t id() const { return (uint32_t)(packed & ID_MASK); }
+
+  uint32_t gen() const { return (uint32_t)(packed >> IdBits) & MAX_GEN; }
+};
+
+// Sparse slots live in fixed size pages allocated from the arena on first use, so memory
+// follows the ids handed out rather than maxElements. clear() is O(1): it bumps the epoch
+// & resets the id cursor, slots from older epochs are recycled lazily as ids get reused.
+// A slot whose generation runs out is retired instead of wrapping, stale handles never revive.
+template<typename T, typename Handle = GenHandle<24, 8>, uint32_t PageSize = 1024>
+struct PagedGenSparseSetRT {
+  static_assert((PageSize & (PageSize - 1)) == 0, "PageSize must be a power of two");
+  static constexpr uint32_t NONE = UINT32_MAX;
+  static constexpr uint32_t RETIRED_EPOCH = UINT32_MAX;
+
+  struct Slot {
+    uint32_t index; // Dense index while live, next free slot while on the free list
+    uint32_t gen;
+    uint32_t epoch; // Epoch the slot was last handed out in, 0 = never used
+  };
+
+  Arena* arena; // Set at runtime, pages are allocated from it
+  ArrayRT<T>* dense; // Set at runtime
+  ArrayRT<uint32_t>* dense_to_sparse; // Set at runtime
+  Slot** pages; // Set at runtime, nullptr until a page is first touched
+  uint32_t max_elements;
+  uint32_t next_id; // Ids below this were handed out in the current epoch
+  uint32_t free_head;
+  uint32_t epoch;
+
+  PagedGenSparseSetRT() = delete;
+  PagedGenSparseSetRT(const PagedGenSparseSetRT&) = delete;
+  PagedGenSparseSetRT& operator=(const PagedGenSparseSetRT&) = delete;
+  PagedGenSparseSetRT(PagedGenSparseSetRT&& other) = delete;
+  PagedGenSparseSetRT& operator=(PagedGenSparseSetRT&& other) = delete;
+
+  void init(Arena& _arena, uint32_t _max_elements, ArrayRT<T>& _dense, ArrayRT<uint32_t>& _dense_to_sparse, Slot** _pages) {
+    LOG_ASSERT(_max_elements <= Handle::MAX_IDS, "maxElements exceeds the handle's id bits");
+    arena = &_arena;
+    max_elements = _max_elements;
+    dense = &_dense;
+    dense_to_sparse = &_dense_to_sparse;
+    pages = _pages;
+    next_id = 0;
+    free_head = NONE;
+    epoch = 1;
+  }
+
+  static uint32_t page_count(uint32_t max_elements) {
+    return (max_elements + PageSize - 1) / PageSize;
+  }
+
+  void allocate_page(uint32_t page); // Defined after Arena
+
+  Slot* find_slot(uint32_t id) const {
+    if (id >= max_elements) return nullptr;
+    Slot* page = pages[id / PageSize];
+    if (!page) return nullptr;
+    return &page[id & (PageSize - 1)];
+  }
+
+  Slot& slot(uint32_t id) {
+    uint32_t page = id / PageSize;
+    if (!pages[page]) allocate_page(page);
+    return pages[page][id & (PageSize - 1)];
+  }
+
+  // Bumps the slot's generation for reuse, retires it when there is no generation left
+  bool claim(Slot& entry) {
+    if (entry.epoch == RETIRED_EPOCH) return false;
+    if (entry.epoch != 0) {
+      if (entry.gen == Handle::MAX_GEN) {
+        entry.epoch = RETIRED_EPOCH;
+        return false;
+      }
+      entry.gen++;
+    }
+    entry.epoch = epoch;
+    return true;
+  }
+
+  Handle add(const T& val) {
+    LOG_ASSERT(!is_full(), "GenSparseSet Full!");
+    uint32_t id = NONE;
+    while (free_head != NONE && id == NONE) {
+      Slot& entry = slot(free_head);
+      uint32_t candidate = free_head;
+      free_head = entry.index;
+      if (claim(entry)) id = candidate;
+    }
+    while (id == NONE) {
+      LOG_ASSERT(next_id < max_elements, "GenSparseSet ran out of ids, too many retired slots");
+      uint32_t candidate = next_id++;
+      if (claim(slot(candidate))) id = candidate;
+    }
+
+    Slot& entry = slot(id);
+    entry.index = dense->size();
+    dense->add(val);
+    dense_to_sparse->add(id);
+    return Handle::create(id, entry.gen);
+  }
+
+  Slot* live_slot(Handle handle) const {
+    Slot* entry = find_slot(handle.id());
+    if (!entry || entry->epoch != epoch || entry->gen != handle.gen()) return nullptr;
+    if (entry->index >= dense->size() || dense_to_sparse->get(entry->index) != handle.id()) return nullptr;
+    return entry;
+  }
+
+  void remove(Handle handle) {
+    Slot* entry = live_slot(handle);
+    if (!entry) return;
+
+    uint32_t idx = entry->index;
+    uint32_t moved = dense_to_sparse->back();
+    dense->remove(idx);
+    dense_to_sparse->remove(idx);
+    slot(moved).index = idx;
+
+    entry->index = free_head;
+    free_head = handle.id();
+  }
+
+  T* get(Handle handle) {
+    Slot* entry = live_slot(handle);
+    if (!entry) return nullptr;
+    return &dense->get(entry->index);
+  }
+
+  T* operator[](Handle handle) {
+    return get(handle);
+  }
+
+  Handle find(const T& value) const {
+    for (uint32_t i = 0; i < dense->size(); i++) {
+      if (dense->get(i) == value) {
+        uint32_t id = dense_to_sparse->get(i);
+        return Handle::create(id, find_slot(id)->gen);
+      }
+    }
+    return Handle::null();
+  }
+
+  bool contains(Handle handle) const {
+    return live_slot(handle) != nullptr;
+  }
+
+  void clear() {
+    dense->clear();
+    dense_to_sparse->clear();
+    next_id = 0;
+    free_head = NONE;
+    if (++epoch == RETIRED_EPOCH) epoch = 1;
+  }
+
+  uint32_t size() const { return dense->size(); }
+
+  bool empty() const { return dense->empty(); }
+
+  bool is_full() const { return dense->size() == max_elements; }
+
+  uint32_t capacity() const { return max_elements; }
+
+  using Iterator = typename ArrayRT<T>::Iterator;
+  Iterator begin() { return dense->begin(); }
+  Iterator end() { return dense->end(); }
+};
+
+// NOTE: Component views
+
+// Sparse set keyed by an entity GenId handed out elsewhere (e.g. by a GenSparseSetRT), so
+// several component sets share ids & can be joined by View & Group.
+template<typename T>
+struct ComponentSetRT {
+  static constexpr uint32_t NONE = UINT32_MAX;
+  ArrayRT<T>* dense; // Set at runtime
+  ArrayRT<GenId>* dense_ids; // Set at runtime, entity of each dense element
+  ArrayRT<uint32_t>* sparse; // Set at runtime, entity id -> dense index
+  void* owner; // Group keeping this set's dense order, nullptr if none
+  void (*on_add)(void* owner, GenId entity); // Code pointers into the module that bound them, Group::attach re-binds
+  void (*on_remove)(void* owner, GenId entity); // them after every reload & detach clears them before unloading
+
+  ComponentSetRT() = delete;
+  ComponentSetRT(const ComponentSetRT&) = delete;
+  ComponentSetRT& operator=(const ComponentSetRT&) = delete;
+  ComponentSetRT(ComponentSetRT&& other) = delete;
+  ComponentSetRT& operator=(ComponentSetRT&& other) = delete;
+
+  void init(ArrayRT<T>& _dense, ArrayRT<GenId>& _dense_ids, ArrayRT<uint32_t>& _sparse) {
+    dense = &_dense;
+    dense_ids = &_dense_ids;
+    sparse = &_sparse;
+    owner = nullptr;
+    on_add = nullptr;
+    on_remove = nullptr;
+    sparse->reserve_until(sparse->capacity());
+    for (uint32_t i = 0; i < sparse->size(); i++) sparse->elements[i] = NONE;
+  }
+
+  uint32_t index_of(GenId entity) const {
+    if (entity.id() >= sparse->size()) return NONE;
+    uint32_t idx = sparse->elements[entity.id()];
+    if (idx >= dense_ids->size() || dense_ids->elements[idx] != entity) return NONE;
+    return idx;
+  }
+
+  T& set(GenId entity, const T& val) {
+    uint32_t idx = index_of(entity);
+    if (idx != NONE) return dense->elements[idx] = val;
+
+    LOG_ASSERT(entity.id() < sparse->size(), "Entity id out of bounds!");
+    uint32_t stale = sparse->elements[entity.id()];
+    if (stale < dense_ids->size() && dense_ids->elements[stale].id() == entity.id()) {
+      remove(dense_ids->elements[stale]); // Left behind by an older generation of this id
+    }
+    idx = dense->add(val);
+    dense_ids->add(entity);
+    sparse->elements[entity.id()] = idx;
+    if (owner) {
+      LOG_ASSERT(on_add, "Owned component set has no hooks, call Group::attach after loading the code");
+      on_add(owner, entity);
+      idx = sparse->elements[entity.id()];
+    }
+    return dense->elements[idx];
+  }
+
+  void remove(GenId entity) {
+    if (index_of(entity) == NONE) return;
+    if (owner) {
+      LOG_ASSERT(on_remove, "Owned component set has no hooks, call Group::attach after loading the code");
+      on_remove(owner, entity);
+    }
+
+    uint32_t idx = sparse->elements[entity.id()];
+    GenId moved = dense_ids->back();
+    dense->remove(idx);
+    dense_ids->remove(idx);
+    sparse->elements[moved.id()] = idx;
+    sparse->elements[entity.id()] = NONE;
+  }
+
+  T* get(GenId entity) {
+    uint32_t idx = index_of(entity);
+    if (idx == NONE) return nullptr;
+    return &dense->elements[idx];
+  }
+
+  T* operator[](GenId entity) {
+    return get(entity);
+  }
+
+  bool contains(GenId entity) const {
+    return index_of(entity) != NONE;
+  }
+
+  void swap_dense(uint32_t a, uint32_t b) {
+    if (a == b) return;
+    ::swap(dense->elements[a], dense->elements[b]);
+    ::swap(dense_ids->elements[a], dense_ids->elements[b]);
+    sparse->elements[dense_ids->elements[a].id()] = a;
+    sparse->elements[dense_ids->elements[b].id()] = b;
+  }
+
+  void clear() { // Sparse entries are validated against dense_ids, no need to reset them
+    LOG_ASSERT(!owner, "Clear the owning group's sets through Group::clear");
+    dense->clear();
+    dense_ids->clear();
+  }
+
+  uint32_t size() const { return dense->size(); }
+
+  bool empty() const { return dense->empty(); }
+
+  uint32_t capacity() const { return dense->capacity(); }
+
+  using Iterator = typename ArrayRT<T>::Iterator;
+  Iterator begin() { return dense->begin(); }
+  Iterator end() { return dense->end(); }
+};
+
+// Joins component sets without owning them: walks the smallest set & probes the others,
+// prefetching their sparse entries a few entities ahead.
+// e.g. View<Transform, Velocity>(transforms, velocities).each([](GenId e, Transform& t, Velocity& v) {});
+template<typename... Ts>
+struct View {
+  static constexpr uint32_t prefetchDistance = 8;
+  std::tuple<ComponentSetRT<Ts>*...> sets;
+
+  explicit View(ComponentSetRT<Ts>&... _sets) : sets(&_sets...) {}
+
+  template<typename Fn>
+  void each(Fn&& fn) {
+    each_impl(fn, std::index_sequence_for<Ts...>{});
+  }
+
+  uint32_t size_hint() const { // Upper bound on the entities each() visits
+    uint32_t smallest = UINT32_MAX;
+    std::apply([&](auto*... set) { ((smallest = std::min(smallest, set->size())), ...); }, sets);
+    return smallest;
+  }
+
+private:
+  template<typename Fn, size_t... I>
+  void each_impl(Fn& fn, std::index_sequence<I...>) {
+    uint32_t smallest = size_hint();
+    bool done = false;
+    ((!done && std::get<I>(sets)->size() == smallest ? (each_from<I>(fn, std::index_sequence<I...>{}), done = true) : false), ...);
+  }
+
+  template<size_t Lead, typename Fn, size_t... I>
+  void each_from(Fn& fn, std::index_sequence<I...>) {
+    auto* lead = std::get<Lead>(sets);
+    GenId* entities = lead->dense_ids->elements;
+    for (uint32_t i = 0; i < lead->size(); i++) {
+      if (i + prefetchDistance < lead->size()) {
+        uint32_t ahead = entities[i + prefetchDistance].id();
+        (PREFETCH(&std::get<I>(sets)->sparse->elements[ahead]), ...);
+      }
+      GenId entity = entities[i];
+      uint32_t idx[] = {std::get<I>(sets)->index_of(entity)...};
+      bool all = true;
+      for (uint32_t j = 0; j < sizeof...(I); j++) all &= idx[j] != UINT32_MAX;
+      if (all) fn(entity, std::get<I>(sets)->dense->elements[idx[I]]...);
+    }
+  }
+};
 
-    do {
-      if (entries[idx].state == EntryState::Empty) return UINT32_MAX;
-      if (entries[idx].state == EntryState::Occupied && 
-        KeyCompare<KeyType>::equals(entries[idx].key, key)) {
-        return idx;
-      }
-      idx = (idx + 1) % N;
-    } while (idx != original);
+// Owns its component sets & keeps the first count() dense elements of each of them
+// in the same entity order, so iterating the join is a linear sweep over every set.
+// A set can be owned by one group at a time. The sets call back into the group through
+// code pointers, so a group living in an arena that survives a reload must be detached
+// before unloading & attached again after loading, like trace_attach.
+template<typename... Ts>
+struct Group {
+  std::tuple<ComponentSetRT<Ts>*...> sets;
+  uint32_t count;
+
+  Group() = delete;
+  Group(const Group&) = delete;
+  Group& operator=(const Group&) = delete;
+  Group(Group&& other) = delete;
+  Group& operator=(Group&& other) = delete;
+
+  void init(ComponentSetRT<Ts>&... _sets) {
+    sets = std::tuple<ComponentSetRT<Ts>*...>(&_sets...);
+    count = 0;
+    auto own = [this](auto* set) {
+      LOG_ASSERT(!set->owner, "Component set already owned by a group");
+      set->owner = this;
+    };
+    std::apply([&](auto*... set) { (own(set), ...); }, sets);
+    attach();
 
-    return UINT32_MAX;
+    // Pull in entities that already have every component
+    auto* first = std::get<0>(sets);
+    for (uint32_t i = 0; i < first->size(); i++) enter(first->dense_ids->elements[i]);
   }
 
-  uint32_t find_empty_slot(const KeyType& key) {
-    uint32_t hash = hasher(key);
-    uint32_t idx = hash % N;
-    uint32_t original = idx;
-
-    do {
-      if (entries[idx].state != EntryState::Occupied) return idx;
-      idx = (idx + 1) % N;
-    } while (idx != original);
+  void attach() { // Binds the sets' hooks to this module's code
+    std::apply([](auto*... set) { ((set->on_add = &Group::added, set->on_remove = &Group::removed), ...); }, sets);
+  }
 
-    LOG_ASSERT(false, "No empty slots!");
-    return UINT32_MAX;
+  void detach() { // Owned sets assert instead of calling into unloaded code
+    std::apply([](auto*... set) { ((set->on_add = nullptr, set->on_remove = nullptr), ...); }, sets);
   }
 
-  ValueType& get(const KeyType& key) {
-    uint32_t idx = find_slot(key);
-    if (idx == UINT32_MAX) {
-      LOG_ASSERT(count < N * maxLoadFactor, "HashMap too full!");
-      idx = find_empty_slot(key);
-      entries[idx].key = key;
-      entries[idx].value = ValueType{};
-      entries[idx].state = EntryState::Occupied;
-      count++;
-    }
-    return entries[idx].value;
+  bool owns(GenId entity) const {
+    uint32_t idx = std::get<0>(sets)->index_of(entity);
+    return idx != UINT32_MAX && idx < count;
   }
 
-  ValueType& operator[](const KeyType& key) {
-    return get(key);
+  template<typename Fn>
+  void each(Fn&& fn) {
+    each_impl(fn, std::index_sequence_for<Ts...>{});
   }
 
-  void remove(const KeyType& key) {
-    uint32_t idx = find_slot(key);
-    if (idx != UINT32_MAX) {
-      entries[idx].state = EntryState::Dead;
-      count--;
-    }
+  template<uint32_t I>
+  auto column() { // Grouped components of the I-th set, aligned with every other column
+    auto* set = std::get<I>(sets);
+    return Span<std::remove_reference_t<decltype(set->dense->elements[0])>>{set->dense->elements, count};
   }
 
-  bool contains(const KeyType& key) const {
-    return find_slot(key) != UINT32_MAX;
+  Span<GenId> entities() {
+    return Span<GenId>{std::get<0>(sets)->dense_ids->elements, count};
   }
 
   uint32_t size() const { return count; }
 
-  bool empty() const { return count == 0; }
-
   void clear() {
-    for (uint32_t i = 0; i < N; i++) {
-      entries[i].state = EntryState::Empty;
-    }
     count = 0;
+    std::apply([](auto*... set) { ((set->dense->clear(), set->dense_ids->clear()), ...); }, sets);
   }
 
-  uint32_t capacity() const { return maxElements; }
-
-  bool is_full() const { return size() == capacity(); }
+private:
+  void enter(GenId entity) {
+    if (owns(entity)) return;
+    bool all = std::apply([&](auto*... set) { return (set->contains(entity) && ...); }, sets);
+    if (!all) return;
+    std::apply([&](auto*... set) { (set->swap_dense(set->index_of(entity), count), ...); }, sets);
+    count++;
+  }
 
-  using Iterator = HashMapIterator<KeyType, ValueType>;
-  Iterator begin() { 
-    return Iterator(entries.elements, entries.elements + N); 
+  void leave(GenId entity) {
+    if (!owns(entity)) return;
+    count--;
+    std::apply([&](auto*... set) { (set->swap_dense(set->index_of(entity), count), ...); }, sets);
   }
-  Iterator end() { 
-    return Iterator(entries.elements + N, entries.elements + N); 
+
+  static void added(void* group, GenId entity) { ((Group*)group)->enter(entity); }
+
+  static void removed(void* group, GenId entity) { ((Group*)group)->leave(entity); }
+
+  template<typename Fn, size_t... I>
+  void each_impl(Fn& fn, std::index_sequence<I...>) {
+    GenId* entities = std::get<0>(sets)->dense_ids->elements;
+    for (uint32_t i = 0; i < count; i++) fn(entities[i], std::get<I>(sets)->dense->elements[i]...);
   }
 };
 
-template<typename KeyType, typename ValueType>
-struct HashMapRT {
-  ArrayRT<HashEntry<KeyType, ValueType>>* entries; // Set at runtime
-  uint32_t maxElements; // Set at runtime
-  uint32_t count = 0;
-  static constexpr float maxLoadFactor = 0.7f;
-  Hash<KeyType> hasher;
+// NOTE: Pool
 
-  HashMapRT() = delete;
-  HashMapRT(const HashMapRT&) = delete;
-  HashMapRT& operator=(const HashMapRT&) = delete;
-  HashMapRT(HashMapRT&& other) = delete;
-  HashMapRT& operator=(HashMapRT&& other) = delete;
+struct PoolStats {
+  uint32_t live;
+  uint32_t peak;
+  uint32_t capacity; // Slots in allocated blocks
+  uint32_t maxElements;
+};
 
-  void init(ArrayRT<HashEntry<KeyType, ValueType>>& Aentries, uint32_t AmaxElements) {
-    Aentries.reserve_until(AmaxElements);
-    entries = &Aentries;
-    maxElements = AmaxElements;
-    clear();
-  }
+// Fixed size objects carved from an arena in blocks of blockSize & recycled through an
+// intrusive free list. Pointers stay stable, handles are GenIds checked against the slot's generation.
+template<typename T>
+struct Pool {
+  static constexpr uint32_t NONE = UINT32_MAX;
+
+  struct Slot {
+    alignas(T) alignas(uint32_t) unsigned char storage[sizeof(T) < sizeof(uint32_t) ? sizeof(uint32_t) : sizeof(T)]; // Next free id while free
+    uint32_t id;
+    uint8_t gen;
+    bool live;
+  };
 
-  uint32_t find_slot(const KeyType& key) const {
-    uint32_t hash = hasher(key);
-    uint32_t idx = hash % maxElements;
-    uint32_t original = idx;
+  Arena* arena; // Set at runtime, blocks are allocated from it
+  Slot** blocks; // Set at runtime
+  uint32_t blockSize;
+  uint32_t maxBlocks;
+  uint32_t blockCount;
+  uint32_t freeHead;
+  uint32_t liveCount;
+  uint32_t peak;
 
-    do {
-      if (entries->get(idx).state == EntryState::Empty) return UINT32_MAX;
-      if (entries->get(idx).state == EntryState::Occupied && 
-        KeyCompare<KeyType>::equals(entries->get(idx).key, key)) {
-        return idx;
-      }
-      idx = (idx + 1) % maxElements;
-    } while (idx != original);
+  Pool() = delete;
+  Pool(const Pool&) = delete;
+  Pool& operator=(const Pool&) = delete;
+  Pool(Pool&& other) = delete;
+  Pool& operator=(Pool&& other) = delete;
 
-    return UINT32_MAX;
+  void init(Arena& _arena, Slot** _blocks, uint32_t _blockSize, uint32_t _maxBlocks) {
+    LOG_ASSERT((uint64_t)_blockSize * _maxBlocks <= GenId::ID_MASK, "Pool exceeds GenId's id bits");
+    arena = &_arena;
+    blocks = _blocks;
+    blockSize = _blockSize;
+    maxBlocks = _maxBlocks;
+    blockCount = 0;
+    freeHead = NONE;
+    liveCount = 0;
+    peak = 0;
   }
 
-  uint32_t find_empty_slot(const KeyType& key) {
-    uint32_t hash = hasher(key);
-    uint32_t idx = hash % maxElements;
-    uint32_t original = idx;
+  void grow(); // Defined after Arena
 
-    do {
-      if (entries->get(idx).state != EntryState::Occupied) return idx;
-      idx = (idx + 1) % maxElements;
-    } while (idx != original);
+  Slot& slot(uint32_t id) {
+    return blocks[id / blockSize][id % blockSize];
+  }
 
-    LOG_ASSERT(false, "No empty slots!");
-    return UINT32_MAX;
+  uint32_t& next_free(Slot& entry) {
+    return *(uint32_t*)entry.storage;
   }
 
-  ValueType& get(const KeyType& key) {
-    uint32_t idx = find_slot(key);
-    if (idx == UINT32_MAX) {
-      LOG_ASSERT(count < maxElements * maxLoadFactor, "HashMap too full!");
-      idx = find_empty_slot(key);
-      entries->get(idx).key = key;
-      entries->get(idx).value = ValueType{};
-      entries->get(idx).state = EntryState::Occupied;
-      count++;
-    }
-    return entries->get(idx).value;
+  template<typename... Args>
+  T* alloc(Args... args) {
+    if (freeHead == NONE) grow();
+    Slot& entry = slot(freeHead);
+    freeHead = next_free(entry);
+    entry.live = true;
+    if (++liveCount > peak) peak = liveCount;
+    return new (entry.storage) T(args...);
   }
 
-  ValueType& operator[](const KeyType& key) {
-    return get(key);
+  void free(T* ptr) {
+    Slot& entry = *(Slot*)ptr;
+    LOG_ASSERT(entry.live, "Double free in Pool!");
+    ptr->~T();
+    entry.live = false;
+    entry.gen++;
+    next_free(entry) = freeHead;
+    freeHead = entry.id;
+    liveCount--;
   }
 
-  void remove(const KeyType& key) {
-    uint32_t idx = find_slot(key);
-    if (idx != UINT32_MAX) {
-      entries->get(idx).state = EntryState::Dead;
-      count--;
-    }
+  template<typename... Args>
+  GenId alloc_handle(Args... args) {
+    Slot& entry = *(Slot*)alloc(args...);
+    return GenId::create(entry.id, entry.gen);
   }
 
-  bool contains(const KeyType& key) const {
-    return find_slot(key) != UINT32_MAX;
+  T* get(GenId handle) {
+    if (handle.id() >= blockCount * blockSize) return nullptr;
+    Slot& entry = slot(handle.id());
+    if (!entry.live || entry.gen != handle.gen()) return nullptr;
+    return (T*)entry.storage;
   }
 
-  uint32_t size() const { return count; }
+  T* operator[](GenId handle) {
+    return get(handle);
+  }
 
-  bool empty() const { return count == 0; }
+  void free(GenId handle) {
+    T* ptr = get(handle);
+    if (ptr) free(ptr);
+  }
 
-  void clear() {
-    for (uint32_t i = 0; i < maxElements; i++) {
-      entries->get(i).state = EntryState::Empty;
-    }
-    count = 0;
+  GenId handle_of(const T* ptr) const {
+    const Slot& entry = *(const Slot*)ptr;
+    return GenId::create(entry.id, entry.gen);
   }
 
-  uint32_t capacity() const { return maxElements; }
+  uint32_t size() const { return liveCount; }
 
-  bool is_full() const { return size() == capacity(); }
+  bool empty() const { return liveCount == 0; }
 
-  using Iterator = HashMapIterator<KeyType, ValueType>;
-  Iterator begin() { 
-    return Iterator(entries->elements, entries->elements + maxElements); 
-  }
-  Iterator end() { 
-    return Iterator(entries->elements + maxElements, entries->elements + maxElements); 
+  PoolStats stats() const {
+    return PoolStats{liveCount, peak, blockCount * blockSize, maxBlocks * blockSize};
   }
 };
 
-// NOTE: Generational Sparse set
+struct SlabClassStats {
+  uint32_t live;
+  uint32_t peak;
+  uint32_t slabs;
+};
 
-struct GenId {
-  static constexpr uint32_t GEN_BITS = 8;
-  static constexpr uint32_t ID_BITS = 24;
-  static constexpr uint32_t ID_MASK = (1u << ID_BITS) - 1;
-  static constexpr uint32_t GEN_MASK = ((1u << GEN_BITS) - 1) << ID_BITS;
+// Size class allocator for short lived variable sized objects (network messages, path requests).
+// Sizes round up to the next power of two from 16 to 2048 bytes, each class refills from
+// slabSize arena chunks & recycles through an intrusive free list. free() must get the alloc size.
+struct SlabAllocator {
+  static constexpr uint32_t minClassShift = 4;
+  static constexpr uint32_t classCount = 8;
+  static constexpr uint64_t maxSize = 1ull << (minClassShift + classCount - 1);
+  static constexpr uint64_t slabSize = 64 * 1024;
+
+  struct FreeBlock {
+    FreeBlock* next;
+  };
 
-  uint32_t packed;
+  Arena* arena; // Set at runtime, slabs are allocated from it
+  FreeBlock* freeLists[classCount];
+  SlabClassStats classStats[classCount];
 
-  bool operator==(const GenId& other) const {
-    return packed == other.packed;
-  }
+  SlabAllocator() = delete;
+  SlabAllocator(const SlabAllocator&) = delete;
+  SlabAllocator& operator=(const SlabAllocator&) = delete;
+  SlabAllocator(SlabAllocator&& other) = delete;
+  SlabAllocator& operator=(SlabAllocator&& other) = delete;
 
-  bool operator!=(const GenId& other) const {
-    return !(*this==other);
+  void init(Arena& _arena) {
+    arena = &_arena;
+    memset(freeLists, 0, sizeof(freeLists));
+    memset(classStats, 0, sizeof(classStats));
   }
 
-  static GenId create(uint32_t id, uint8_t gen) {
-    LOG_ASSERT(id < (1u << ID_BITS), "ID exceeds 24 bits");
-    return GenId{(gen << ID_BITS) | id};
+  static uint32_t size_class(uint64_t size) {
+    uint32_t sizeClass = 0;
+    while (((uint64_t)1 << (minClassShift + sizeClass)) < size) sizeClass++;
+    return sizeClass;
   }
 
-  void set_id(uint32_t id) {
-    LOG_ASSERT(id < (1u << ID_BITS), "ID exceeds 24 bits");
-    packed = (packed & ~ID_MASK) | id;
+  static uint64_t class_size(uint32_t sizeClass) {
+    return (uint64_t)1 << (minClassShift + sizeClass);
   }
 
-  void set_gen(uint8_t gen) {
-    packed = (packed & ID_MASK) | (gen << ID_BITS);
+  void refill(uint32_t sizeClass); // utils.cpp
+
+  void* alloc(uint64_t size) {
+    LOG_ASSERT(size <= maxSize, "Slab allocations are limited to %llu bytes", (unsigned long long)maxSize);
+    uint32_t sizeClass = size_class(size);
+    if (!freeLists[sizeClass]) refill(sizeClass);
+    FreeBlock* block = freeLists[sizeClass];
+    freeLists[sizeClass] = block->next;
+    SlabClassStats& stats = classStats[sizeClass];
+    if (++stats.live > stats.peak) stats.peak = stats.live;
+    return block;
   }
 
-  void increment_gen() {
-    uint8_t next_gen = (gen() + 1) & ((1 << GEN_BITS) - 1);
-    set_gen(next_gen);
+  void free(void* ptr, uint64_t size) {
+    uint32_t sizeClass = size_class(size);
+    FreeBlock* block = (FreeBlock*)ptr;
+    block->next = freeLists[sizeClass];
+    freeLists[sizeClass] = block;
+    classStats[sizeClass].live--;
   }
 
-  uint32_t id() const { return packed & ID_MASK; }
+  template<typename T, typename... Args>
+  T* create(Args... args) {
+    return new (alloc(sizeof(T))) T(args...);
+  }
 
-  uint8_t gen() const { return (packed >> ID_BITS) & ((1u << GEN_BITS) - 1); }
+  template<typename T>
+  void destroy(T* ptr) {
+    ptr->~T();
+    free(ptr, sizeof(T));
+  }
 };
 
-template<typename T, uint32_t N>
-struct GenSparseSetCT {
-  ArrayCT<T, N> dense;
-  ArrayCT<GenId, N> sparse;
-  ArrayCT<uint32_t, N> dense_to_sparse;
-  uint32_t free_head;
+// NOTE: Ring buffers
 
-  void init() {
-    sparse.reserve_until(N);
-    for (uint32_t i = 0; i < N-1; i++) {
-      auto& entry = sparse[i];
-      entry.set_id(i + 1);
-      entry.set_gen(0);
+// Lock-free single producer / single consumer queue. Each side keeps a cached copy of the
+// other side's index & only touches the shared cache line when the cache says full/empty.
+template<typename T>
+struct SPSCQueueRT {
+  alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> head; // Next slot to pop, written by the consumer
+  uint64_t cachedTail;
+  alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> tail; // Next slot to push, written by the producer
+  uint64_t cachedHead;
+  alignas(CACHE_LINE_SIZE) T* elements; // Set at runtime
+  uint64_t mask;
+
+  SPSCQueueRT() = delete;
+  SPSCQueueRT(const SPSCQueueRT&) = delete;
+  SPSCQueueRT& operator=(const SPSCQueueRT&) = delete;
+  SPSCQueueRT(SPSCQueueRT&& other) = delete;
+  SPSCQueueRT& operator=(SPSCQueueRT&& other) = delete;
+
+  void init(T* _elements, uint32_t capacity) {
+    LOG_ASSERT(capacity && (capacity & (capacity - 1)) == 0, "Queue capacity must be a power of two");
+    elements = _elements;
+    mask = capacity - 1;
+    head.store(0, std::memory_order_relaxed);
+    tail.store(0, std::memory_order_relaxed);
+    cachedHead = 0;
+    cachedTail = 0;
+  }
+
+  // Producer side, returns how many of the count elements fit
+  uint32_t try_push(const T* values, uint32_t count) {
+    uint64_t t = tail.load(std::memory_order_relaxed);
+    uint64_t free = mask + 1 - (t - cachedHead);
+    if (free < count) {
+      cachedHead = head.load(std::memory_order_acquire);
+      free = mask + 1 - (t - cachedHead);
     }
-    auto& last = sparse[N-1];
-    last.set_id(N);
-    last.set_gen(0);
-    free_head = 0;
+    uint32_t pushed = count < free ? count : (uint32_t)free;
+    for (uint32_t i = 0; i < pushed; i++) elements[(t + i) & mask] = values[i];
+    tail.store(t + pushed, std::memory_order_release);
+    return pushed;
   }
 
-  GenId add(const T& val) {
-    auto& entry = sparse[free_head];
-    uint32_t next_free = entry.id();
-    uint32_t dense_idx = dense.size();
+  bool try_push(const T& value) {
+    return try_push(&value, 1) == 1;
+  }
 
-    dense.add(val);
-    dense_to_sparse.add(free_head);
-    entry.set_id(dense_idx);
+  void push(const T& value) { // Spins until there is room
+    while (!try_push(value)) std::this_thread::yield();
+  }
 
-    GenId res = GenId::create(free_head, entry.gen());
-    free_head = next_free;
+  // Consumer side, returns how many elements were written to out
+  uint32_t try_pop(T* out, uint32_t maxCount) {
+    uint64_t h = head.load(std::memory_order_relaxed);
+    uint64_t available = cachedTail - h;
+    if (available < maxCount) {
+      cachedTail = tail.load(std::memory_order_acquire);
+      available = cachedTail - h;
+    }
+    uint32_t popped = maxCount < available ? maxCount : (uint32_t)available;
+    for (uint32_t i = 0; i < popped; i++) out[i] = elements[(h + i) & mask];
+    head.store(h + popped, std::memory_order_release);
+    return popped;
+  }
 
-    return res;
+  bool try_pop(T& out) {
+    return try_pop(&out, 1) == 1;
   }
 
-  void remove(GenId genId) {
-    if (genId.id() >= N) return;
+  T pop() { // Spins until there is an element
+    T value;
+    while (!try_pop(value)) std::this_thread::yield();
+    return value;
+  }
 
-    auto& entry = sparse[genId.id()];
-    if (entry.gen() != genId.gen()) return;
-    uint32_t prev_back = dense_to_sparse.back();
+  uint32_t size() const { // Exact only when called from one of the two sides while the other is idle
+    return (uint32_t)(tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire));
+  }
 
-    dense.remove(entry.id());
-    dense_to_sparse.remove(entry.id());
-    sparse[prev_back].set_id(entry.id());
+  bool empty() const { return size() == 0; }
 
-    entry.set_id(free_head);
-    entry.increment_gen();
-    free_head = genId.id();
-  }
+  uint32_t capacity() const { return (uint32_t)(mask + 1); }
+};
 
-  T* get(GenId genId) {
-    if (genId.id() >= N) return nullptr;
-    const auto& entry = sparse[genId.id()];
-    if (entry.id() >= dense.size()) return nullptr;
-    if (entry.gen() != genId.gen()) return nullptr;
-    return &dense[entry.id()];
-  }
+// Bounded multi producer / multi consumer queue (Dmitry Vyukov). Every cell carries a
+// sequence number telling producers & consumers whose turn it is, so there is no lock.
+template<typename T>
+struct MPMCQueueRT {
+  struct Cell {
+    std::atomic<uint64_t> sequence;
+    T value;
+  };
 
-  T* operator[](GenId genId) {
-    return get(genId);
+  alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> enqueuePos;
+  alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> dequeuePos;
+  alignas(CACHE_LINE_SIZE) Cell* cells; // Set at runtime
+  uint64_t mask;
+
+  MPMCQueueRT() = delete;
+  MPMCQueueRT(const MPMCQueueRT&) = delete;
+  MPMCQueueRT& operator=(const MPMCQueueRT&) = delete;
+  MPMCQueueRT(MPMCQueueRT&& other) = delete;
+  MPMCQueueRT& operator=(MPMCQueueRT&& other) = delete;
+
+  void init(Cell* _cells, uint32_t capacity) {
+    LOG_ASSERT(capacity >= 2 && (capacity & (capacity - 1)) == 0, "Queue capacity must be a power of two >= 2");
+    cells = _cells;
+    mask = capacity - 1;
+    for (uint32_t i = 0; i < capacity; i++) new (&cells[i].sequence) std::atomic<uint64_t>(i);
+    enqueuePos.store(0, std::memory_order_relaxed);
+    dequeuePos.store(0, std::memory_order_relaxed);
+  }
+
+  bool try_push(const T& value) {
+    uint64_t pos = enqueuePos.load(std::memory_order_relaxed);
+    while (true) {
+      Cell& cell = cells[pos & mask];
+      uint64_t sequence = cell.sequence.load(std::memory_order_acquire);
+      int64_t diff = (int64_t)sequence - (int64_t)pos;
+      if (diff == 0) {
+        if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          cell.value = value;
+          cell.sequence.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false; // Full
+      } else {
+        pos = enqueuePos.load(std::memory_order_relaxed);
+      }
+    }
   }
 
-  GenId find(const T& value) const {
-    for (uint32_t i = 0; i < dense.size(); i++) {
-      if (dense[i] == value) {
-        uint32_t sparse_idx = dense_to_sparse[i];
-        return GenId::create(sparse_idx, sparse[sparse_idx].gen());
+  bool try_pop(T& out) {
+    uint64_t pos = dequeuePos.load(std::memory_order_relaxed);
+    while (true) {
+      Cell& cell = cells[pos & mask];
+      uint64_t sequence = cell.sequence.load(std::memory_order_acquire);
+      int64_t diff = (int64_t)sequence - (int64_t)(pos + 1);
+      if (diff == 0) {
+        if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          out = cell.value;
+          cell.sequence.store(pos + mask + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false; // Empty
+      } else {
+        pos = dequeuePos.load(std::memory_order_relaxed);
       }
     }
-    return {UINT32_MAX};
   }
 
-  bool contains(GenId genId) const {
-    if (genId.id() >= sparse.size()) return false;
-    const auto& entry = sparse[genId.id()];
-    if (entry.id() >= dense.size()) return false;
-    return entry.gen() == genId.gen();
+  uint32_t try_push(const T* values, uint32_t count) { // Stops at the first full slot
+    uint32_t pushed = 0;
+    while (pushed < count && try_push(values[pushed])) pushed++;
+    return pushed;
   }
 
-  void clear() {
-    dense.clear();
-    dense_to_sparse.clear();
-
-    // Rebuild free list while preserving generations
-    for (uint32_t i = 0; i < N-1; i++) {
-      auto& entry = sparse[i];
-      entry.increment_gen();
-      entry.set_id(i + 1);
-    }
-
-    auto& last = sparse[N-1];
-    last.increment_gen();
-    last.set_id(N);
-
-    free_head = 0;
+  uint32_t try_pop(T* out, uint32_t maxCount) {
+    uint32_t popped = 0;
+    while (popped < maxCount && try_pop(out[popped])) popped++;
+    return popped;
   }
 
-  uint32_t size() const { return dense.size(); }
+  void push(const T& value) { // Spins until there is room
+    while (!try_push(value)) std::this_thread::yield();
+  }
 
-  bool empty() const { return dense.empty(); }
+  T pop() { // Spins until there is an element
+    T value;
+    while (!try_pop(value)) std::this_thread::yield();
+    return value;
+  }
 
-  bool is_full() const { return dense.size() == dense.capacity(); }
+  uint32_t size() const { // Approximate while other threads are pushing or popping
+    uint64_t enqueued = enqueuePos.load(std::memory_order_acquire);
+    uint64_t dequeued = dequeuePos.load(std::memory_order_acquire);
+    return enqueued > dequeued ? (uint32_t)(enqueued - dequeued) : 0;
+  }
 
-  bool capacity() const { return dense.capacity(); }
+  bool empty() const { return size() == 0; }
 
-  using Iterator = typename ArrayCT<T, N>::Iterator;
-  Iterator begin() { return dense.begin(); }
-  Iterator end() { return dense.end(); }
+  uint32_t capacity() const { return (uint32_t)(mask + 1); }
 };
 
-template<typename T>
-struct GenSparseSetRT {
-  uint32_t N; // Set at runtime
-  ArrayRT<T>* dense; // Set at runtime
-  ArrayRT<GenId>* sparse; // Set at runtime
-  ArrayRT<uint32_t>* dense_to_sparse; // Set at runtime
-  uint32_t free_head;
-
-  void init(uint32_t _N, ArrayRT<T>& _dense, ArrayRT<GenId>& _sparse, ArrayRT<uint32_t>& _dense_to_sparse) {
-    N = _N;
-    dense = &_dense;
-    sparse = &_sparse;
-    dense_to_sparse = &_dense_to_sparse;
-
-    sparse->reserve_until(N);
-    for (uint32_t i = 0; i < N-1; i++) {
-      auto& entry = sparse->get(i);
-      entry.set_id(i + 1);
-      entry.set_gen(0);
-    }
-    auto& last = sparse->get(N-1);
-    last.set_id(N);
-    last.set_gen(0);
-    free_head = 0;
-  }
-
-  GenId add(const T& val) {
-    auto& entry = sparse->get(free_head);
-    uint32_t next_free = entry.id();
-    uint32_t dense_idx = dense->size();
+// NOTE: Arena index
+
+// FNV-1a with a splitmix64 finalizer, constexpr so names hash at compile time.
+// Never returns 0 as that marks an empty ArenaIndexCT slot.
+constexpr uint64_t symbol_hash(const char* str) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (; *str; ++str) {
+    hash ^= (uint8_t)*str;
+    hash *= 1099511628211ULL;
+  }
+  hash ^= hash >> 30;
+  hash *= 0xbf58476d1ce4e5b9ULL;
+  hash ^= hash >> 27;
+  hash *= 0x94d049bb133111ebULL;
+  hash ^= hash >> 31;
+  return hash ? hash : 1;
+}
 
-    dense->add(val);
-    dense_to_sparse->add(free_head);
-    entry.set_id(dense_idx);
+struct Symbol {
+  uint64_t hash;
+  const char* name; // Only for logging, may point into code that has since been reloaded
 
-    GenId res = GenId::create(free_head, entry.gen());
-    free_head = next_free;
+  constexpr Symbol(uint64_t Ahash, const char* Aname) : hash(Ahash), name(Aname) {}
+  constexpr Symbol(const char* Aname) : hash(symbol_hash(Aname)), name(Aname) {}
+};
 
-    return res;
-  }
+// Forces the hash to be computed at compile time
+#define SYMBOL(str) Symbol(std::integral_constant<uint64_t, symbol_hash(str)>::value, str)
 
-  void remove(GenId genId) {
-    if (genId.id() >= N) return;
+// Open addressed table from symbol hash to byte offset in the owning arena. Stores no
+// pointers, so it stays valid across hot reloads, and all zero memory is an empty index.
+template<uint32_t N>
+struct ArenaIndexCT {
+  static_assert(N > 0 && (N & (N - 1)) == 0, "ArenaIndexCT size must be a power of two");
+  static constexpr uint32_t maxElements = N * 3 / 4;
 
-    auto& entry = sparse->get(genId.id());
-    if (entry.gen() != genId.gen()) return;
-    uint32_t prev_back = dense_to_sparse->back();
+  struct Slot {
+    uint64_t hash; // 0 when empty
+    uint64_t offset;
+  };
 
-    dense->remove(entry.id());
-    dense_to_sparse->remove(entry.id());
-    sparse->get(prev_back).set_id(entry.id());
+  Slot slots[N];
+  uint32_t count;
 
-    entry.set_id(free_head);
-    entry.increment_gen();
-    free_head = genId.id();
-  }
+  ArenaIndexCT() = default;
+  ArenaIndexCT(const ArenaIndexCT&) = delete;
+  ArenaIndexCT& operator=(const ArenaIndexCT&) = delete;
+  ArenaIndexCT(ArenaIndexCT&& other) = delete;
+  ArenaIndexCT& operator=(ArenaIndexCT&& other) = delete;
 
-  T* get(GenId genId) {
-    if (genId.id() >= N) return nullptr;
-    const auto& entry = sparse->get(genId.id());
-    if (entry.id() >= dense->size()) return nullptr;
-    if (entry.gen() != genId.gen()) return nullptr;
-    return &dense->get(entry.id());
+  void init() {
+    clear();
   }
 
-  T* operator[](GenId genId) {
-    return get(genId);
+  uint32_t find_slot(uint64_t hash) const {
+    for (uint32_t idx = (uint32_t)hash & (N - 1);; idx = (idx + 1) & (N - 1)) {
+      if (slots[idx].hash == hash || slots[idx].hash == 0) return idx;
+    }
   }
 
-  GenId find(const T& value) const {
-    for (uint32_t i = 0; i < dense->size(); i++) {
-      if (dense->get(i) == value) {
-        uint32_t sparse_idx = dense_to_sparse->get(i);
-        return GenId::create(sparse_idx, sparse->get(sparse_idx).gen());
-      }
+  void set(Symbol key, uint64_t offset) {
+    uint32_t idx = find_slot(key.hash);
+    if (slots[idx].hash == 0) {
+      LOG_ASSERT(count < maxElements, "ArenaIndex too full to add %s!", key.name);
+      slots[idx].hash = key.hash;
+      count++;
     }
-    return {UINT32_MAX};
+    slots[idx].offset = offset;
   }
 
-  bool contains(GenId genId) const {
-    if (genId.id() >= sparse->size()) return false;
-    const auto& entry = sparse->get(genId.id());
-    if (entry.id() >= dense->size()) return false;
-    return entry.gen() == genId.gen();
+  uint64_t find(Symbol key) const { // UINT64_MAX when missing
+    const Slot& slot = slots[find_slot(key.hash)];
+    return slot.hash ? slot.offset : UINT64_MAX;
   }
 
-  void clear() {
-    dense->clear();
-    dense_to_sparse->clear();
+  bool contains(Symbol key) const {
+    return find(key) != UINT64_MAX;
+  }
 
-    // Rebuild free list while preserving generations
-    for (uint32_t i = 0; i < N-1; i++) {
-      auto& entry = sparse->get(i);
-      entry.increment_gen();
-      entry.set_id(i + 1);
-    }
+  uint32_t size() const { return count; }
 
-    auto& last = sparse->get(N-1);
-    last.increment_gen();
-    last.set_id(N);
+  bool empty() const { return count == 0; }
 
-    free_head = 0;
+  uint32_t capacity() const { return maxElements; }
+
+  void clear() {
+    memset(slots, 0, sizeof(slots));
+    count = 0;
   }
+};
 
-  uint32_t size() const { return dense->size(); }
+// NOTE: Virtual memory
+uint64_t vm_page_size();
+void* vm_reserve(uint64_t size); // Address space only, nullptr on failure
+bool vm_commit(void* ptr, uint64_t size); // Committed pages read as zero
+void vm_decommit(void* ptr, uint64_t size); // Returns the pages to the OS, keeps the reservation
+void vm_release(void* ptr, uint64_t size);
 
-  bool empty() const { return dense->empty(); }
+template<typename T>
+struct alignas(CACHE_LINE_SIZE) CacheLinePadded {
+  T value;
+};
 
-  bool is_full() const { return dense->size() == dense->capacity(); }
+struct ArenaTagStats {
+  static constexpr uint32_t tagSize = 32;
+  char tag[tagSize]; // Copied, a pointer into a reloaded library's strings would dangle
+  uint64_t bytes;
+  uint32_t allocations;
+};
 
-  bool capacity() const { return dense->capacity(); }
+// Optional per arena bookkeeping, enabled by Arena::instrument. Read it directly for an
+// overlay or write it out with write_arena_stats. Every bump of an instrumented arena scans
+// its tags, so callers only instrument when ARENA_STATS_ENABLED, which is off in NDEBUG builds.
+#ifndef ARENA_STATS_ENABLED
+  #ifdef NDEBUG
+    #define ARENA_STATS_ENABLED 0
+  #else
+    #define ARENA_STATS_ENABLED 1
+  #endif
+#endif
 
-  using Iterator = typename ArrayRT<T>::Iterator;
-  Iterator begin() { return dense->begin(); }
-  Iterator end() { return dense->end(); }
+struct ArenaStats {
+  static constexpr uint32_t maxTags = 32;
+  char name[ArenaTagStats::tagSize];
+  uint64_t peakUsed; // Across clears
+  uint64_t allocations;
+  uint64_t clears;
+  uint64_t lastClearTime; // Unix seconds, 0 if never cleared
+  float budget; // Warn once per clear when used passes this fraction of capacity
+  bool overBudget;
+  char currentTag[ArenaTagStats::tagSize]; // Attributed to allocations, see ArenaTagScope, empty for untagged
+  uint32_t tagCount;
+  ArenaTagStats tags[maxTags];
+};
+
+enum class ArenaClear {
+  Zero, // memset up to the high water mark
+  NoZero, // Only rewind, the caller overwrites what it allocates
+  Decommit, // Hand the committed pages back to the OS, they come back zeroed on reuse
 };
 
 // NOTE: Arena
+// Reserves capacity bytes of address space up front & commits it in commitGranularity
+// chunks as used grows, so untouched capacity costs no memory & needs no memset.
 class Arena {
 public:
-  uint32_t capacity;
-  uint32_t used;
+  static constexpr uint64_t commitGranularity = 64 * 1024;
+  static constexpr uint64_t minAlignment = 8;
+  uint64_t capacity;
+  uint64_t used;
+  uint64_t committed; // [0, committed) is backed by memory
+  uint64_t highWater; // Furthest used has reached since the memory was last zeroed
   char* memory;
+  ArenaStats* stats = nullptr; // Instrumentation, off unless instrument() was called
 
   Arena(const Arena&) = delete;
   Arena& operator=(const Arena&) = delete;
   Arena(Arena&& other) = delete;
   Arena& operator=(Arena&& other) = delete;
 
-  explicit Arena(uint32_t size) {
-    memory = (char*)malloc(size);
+  explicit Arena(uint64_t size) {
+    uint64_t pageSize = vm_page_size();
+    capacity = (size + pageSize - 1) & ~(pageSize - 1);
+    memory = (char*)vm_reserve(capacity);
     if (!memory) LOG_ASSERT(false, "Failed to allocate memory!");
-    memset(memory, 0, size);
-    capacity = size;
     used = 0;
+    committed = 0;
+    highWater = 0;
   }
 
-  char& get(uint32_t idx) {
+  char& get(uint64_t idx) {
     LOG_ASSERT(idx < used, "Index out of bounds!");
     return memory[idx];
   }
 
-  char& operator[](uint32_t idx) {
+  char& operator[](uint64_t idx) {
     return get(idx);
   }
 
+  void commit(uint64_t end) { // Backs [0, end) with memory
+    if (end <= committed) return;
+    uint64_t target = (end + commitGranularity - 1) & ~(commitGranularity - 1);
+    if (target > capacity) target = capacity;
+    if (!vm_commit(memory + committed, target - committed)) LOG_ASSERT(false, "Failed to commit memory!");
+    committed = target;
+  }
+
+  // Places the allocation so that (result + offset) is align-aligned, offset lets a header
+  // sit in front of aligned storage. memory is page aligned so offsets & addresses agree.
+  char* bump(uint64_t size, uint64_t align = minAlignment, uint64_t offset = 0) { // Guaranteed to return valid memory or assert
+    LOG_ASSERT(align && (align & (align - 1)) == 0, "Alignment must be a power of two!");
+    uint64_t start = ((used + offset + align - 1) & ~(align - 1)) - offset;
+    uint64_t aligned_size = (size + 7) & ~7ull;  // 8-byte size granularity
+    if (start + aligned_size > capacity) {
+      LOG_ASSERT(false, "Arena %s is full: %llu of %llu bytes used, %llu requested",
+                 stats ? stats->name : "", (unsigned long long)used, (unsigned long long)capacity, (unsigned long long)aligned_size);
+    }
+    char* result = memory + start;
+    used = start + aligned_size;
+    commit(used);
+    if (used > highWater) highWater = used;
+    if (stats) record_alloc(aligned_size);
+    return result;
+  }
+
+  void instrument(ArenaStats& _stats, const char* name, float budget = 0.9f) {
+    stats = &_stats;
+    memset(stats, 0, sizeof(ArenaStats));
+    snprintf(stats->name, sizeof(stats->name), "%s", name);
+    stats->budget = budget;
+    stats->peakUsed = used;
+  }
+
+  void record_alloc(uint64_t size); // utils.cpp
+  void record_clear(); // utils.cpp
+
+  uint64_t save() const {
+    return used;
+  }
+
+  void restore(uint64_t mark) { // Frees everything allocated since save()
+    LOG_ASSERT(mark <= used, "Restoring to a mark past the current allocation!");
+    used = mark;
+  }
+
   template<typename T, typename... Args>
   T& create(Args... args) {
       T* ptr = alloc_raw<T>();
       return *(new (ptr) T(args...));
   }
 
+  template<typename T>
+  static constexpr uint64_t align_of() {
+    return alignof(T) > minAlignment ? alignof(T) : minAlignment;
+  }
+
   template<typename T>
   T* alloc_raw() { // Guaranteed to return valid memory or assert
-    uint32_t size = sizeof(T);
-    uint32_t aligned_size = (size + 7) & ~7;  // 8-byte alignment
-    if (used + aligned_size > capacity) LOG_ASSERT(false, "Arena is full");
-    T* result = (T*)(memory + used);
-    used += aligned_size;
-    return result;
+    return (T*)bump(sizeof(T), align_of<T>());
   }
 
   template<typename T>
@@ -1284,45 +4028,52 @@ public:
   }
 
   template<typename T>
-  T* alloc_raw(uint32_t size) { // Guaranteed to return valid memory or assert
-    uint32_t aligned_size = (size + 7) & ~7;  // 8-byte alignment
-    if (used + aligned_size > capacity) LOG_ASSERT(false, "Arena is full");
-    T* result = (T*)(memory + used);
-    used += aligned_size;
-    return result;
+  T* alloc_raw(uint64_t size) { // Guaranteed to return valid memory or assert
+    return (T*)bump(size, align_of<T>());
   }
 
   template<typename T>
-  T& alloc(uint32_t size) {
+  T& alloc(uint64_t size) {
     return *alloc_raw<T>(size);
   }
 
   template<typename T>
-  T* alloc_count_raw(uint32_t count) { // Guaranteed to return valid memory or assert
-    uint32_t total_size = sizeof(T) * count;
-    uint32_t aligned_size = (total_size + 7) & ~7;  // 8-byte alignment
-    if (used + aligned_size > capacity) LOG_ASSERT(false, "Arena is full");
-    T* result = reinterpret_cast<T*>(memory + used);
-    used += aligned_size;
-    return result;
+  T* alloc_count_raw(uint64_t count) { // Guaranteed to return valid memory or assert
+    return reinterpret_cast<T*>(bump(sizeof(T) * count, align_of<T>()));
   }
 
   template<typename T>
-  T& alloc_count(uint32_t count) {
+  T& alloc_count(uint64_t count) {
     return *alloc_count_raw<T>(count);
   }
 
-  template <typename E, typename M> 
-  E& fetch(const char* key) {
-    M* map_ptr = reinterpret_cast<M*>(memory);
-    void* ptr = map_ptr->get(key);
-    return *reinterpret_cast<E*>(ptr);
+  void* alloc_aligned(uint64_t size, uint64_t align) { // e.g. alloc_aligned(bytes, 32) for AVX loads
+    return bump(size, align < minAlignment ? minAlignment : align);
+  }
+
+  template<typename T>
+  CacheLinePadded<T>* alloc_padded(uint64_t count) { // One cache line per element, no false sharing
+    return reinterpret_cast<CacheLinePadded<T>*>(bump(sizeof(CacheLinePadded<T>) * count, CACHE_LINE_SIZE));
+  }
+
+  template <typename E, typename M>
+  E& fetch(Symbol key) { // M is the ArenaIndexCT at the start of this arena
+    M* index = reinterpret_cast<M*>(memory);
+    uint64_t offset = index->find(key);
+    LOG_ASSERT(offset != UINT64_MAX, "Nothing named %s in this arena!", key.name);
+    return *reinterpret_cast<E*>(memory + offset);
+  }
+
+  uint64_t offset_of(const void* ptr) const {
+    LOG_ASSERT((const char*)ptr >= memory && (const char*)ptr < memory + capacity, "Pointer not in this arena!");
+    return (uint64_t)((const char*)ptr - memory);
   }
 
   template<typename T>
-  ArrayRT<T>& create_array_rt(uint32_t maxElements) {
-    uint32_t total_size = sizeof(ArrayRT<T>) + sizeof(T) * (maxElements - 1);
-    ArrayRT<T>& arr = alloc<ArrayRT<T>>(total_size);
+  ArrayRT<T>& create_array_rt(uint32_t maxElements) { // Element storage starts on a cache line
+    uint64_t total_size = sizeof(ArrayRT<T>) + sizeof(T) * (maxElements - 1);
+    uint64_t align = alignof(T) > CACHE_LINE_SIZE ? alignof(T) : CACHE_LINE_SIZE;
+    ArrayRT<T>& arr = *(ArrayRT<T>*)bump(total_size, align, offsetof(ArrayRT<T>, elements));
     arr.init(maxElements);
     return arr;
   }
@@ -1334,6 +4085,28 @@ public:
     return arr;
   }
 
+  BitsetRT& create_bitset_rt(uint32_t bitCount) {
+    BitsetRT& bitset = alloc<BitsetRT>();
+    uint64_t* bits = (uint64_t*)alloc_aligned(sizeof(uint64_t) * ((bitCount + 63) / 64), CACHE_LINE_SIZE);
+    bitset.init(bits, bitCount);
+    return bitset;
+  }
+
+  template<uint32_t N>
+  BitsetCT<N>& create_bitset_ct() {
+    BitsetCT<N>& bitset = alloc<BitsetCT<N>>();
+    bitset.init();
+    return bitset;
+  }
+
+  template<typename... Fields>
+  SoART<Fields...>& create_soa_rt(uint32_t maxElements) {
+    SoART<Fields...>& soa = alloc<SoART<Fields...>>();
+    void* columns = alloc_aligned(SoART<Fields...>::memory_size(maxElements), SoART<Fields...>::columnAlignment);
+    soa.init(columns, maxElements);
+    return soa;
+  }
+
   template<typename KeyType, typename ValueType>
   MapRT<KeyType, ValueType>& create_map_rt(uint32_t maxElements) {
     MapRT<KeyType, ValueType>& map = alloc<MapRT<KeyType, ValueType>>(sizeof(MapRT<KeyType, ValueType>));
@@ -1352,8 +4125,18 @@ public:
   template<typename KeyType, typename ValueType>
   HashMapRT<KeyType, ValueType>& create_hashmap_rt(uint32_t maxElements) {
     HashMapRT<KeyType, ValueType>& map = alloc<HashMapRT<KeyType, ValueType>>();
-    ArrayRT<HashEntry<KeyType, ValueType>>& entries = create_array_rt<HashEntry<KeyType, ValueType>>(maxElements);
-    map.init(entries, maxElements);
+    uint32_t slotCount = HashCtrl::slot_count(maxElements);
+    ArrayRT<HashEntry<KeyType, ValueType>>& entries = create_array_rt<HashEntry<KeyType, ValueType>>(slotCount);
+    int8_t* ctrl = alloc_count_raw<int8_t>(slotCount);
+    map.init(entries, ctrl, maxElements);
+    return map;
+  }
+
+  template<typename KeyType, typename ValueType>
+  GrowableHashMapRT<KeyType, ValueType>& create_growable_hashmap_rt(uint32_t initialElements) {
+    GrowableHashMapRT<KeyType, ValueType>& map = alloc<GrowableHashMapRT<KeyType, ValueType>>();
+    HashMapRT<KeyType, ValueType>& table = create_hashmap_rt<KeyType, ValueType>(HashCtrl::slot_count(initialElements));
+    map.init(*this, table);
     return map;
   }
 
@@ -1364,6 +4147,13 @@ public:
     return map;
   }
 
+  template<uint32_t N>
+  ArenaIndexCT<N>& create_arena_index_ct() {
+    ArenaIndexCT<N>& index = alloc<ArenaIndexCT<N>>();
+    index.init();
+    return index;
+  }
+
   template<typename T>
   GenSparseSetRT<T>& create_gen_sparse_set_rt(uint32_t maxElements) {
     GenSparseSetRT<T>& genSparseSet = alloc<GenSparseSetRT<T>>();
@@ -1374,6 +4164,75 @@ public:
     return genSparseSet;
   }
 
+  template<typename T, typename Handle = GenHandle<24, 8>, uint32_t PageSize = 1024>
+  PagedGenSparseSetRT<T, Handle, PageSize>& create_paged_gen_sparse_set_rt(uint32_t maxElements) {
+    using Set = PagedGenSparseSetRT<T, Handle, PageSize>;
+    Set& genSparseSet = alloc<Set>();
+    ArrayRT<T>& dense = create_array_rt<T>(maxElements);
+    ArrayRT<uint32_t>& dense_to_sparse = create_array_rt<uint32_t>(maxElements);
+    uint32_t pageCount = Set::page_count(maxElements);
+    typename Set::Slot** pages = alloc_raw<typename Set::Slot*>(sizeof(typename Set::Slot*) * pageCount);
+    memset(pages, 0, sizeof(typename Set::Slot*) * pageCount);
+    genSparseSet.init(*this, maxElements, dense, dense_to_sparse, pages);
+    return genSparseSet;
+  }
+
+  template<typename T>
+  ComponentSetRT<T>& create_component_set_rt(uint32_t maxElements) {
+    ComponentSetRT<T>& set = alloc<ComponentSetRT<T>>();
+    ArrayRT<T>& dense = create_array_rt<T>(maxElements);
+    ArrayRT<GenId>& dense_ids = create_array_rt<GenId>(maxElements);
+    ArrayRT<uint32_t>& sparse = create_array_rt<uint32_t>(maxElements);
+    set.init(dense, dense_ids, sparse);
+    return set;
+  }
+
+  template<typename... Ts>
+  Group<Ts...>& create_group(ComponentSetRT<Ts>&... sets) {
+    Group<Ts...>& group = alloc<Group<Ts...>>();
+    group.init(sets...);
+    return group;
+  }
+
+  template<typename T>
+  Pool<T>& create_pool(uint32_t maxElements, uint32_t blockSize = 256) {
+    Pool<T>& pool = alloc<Pool<T>>();
+    uint32_t maxBlocks = (maxElements + blockSize - 1) / blockSize;
+    typename Pool<T>::Slot** blocks = alloc_count_raw<typename Pool<T>::Slot*>(maxBlocks);
+    pool.init(*this, blocks, blockSize, maxBlocks);
+    return pool;
+  }
+
+  static uint32_t next_power_of_two(uint32_t n) {
+    uint32_t result = 1;
+    while (result < n) result <<= 1;
+    return result;
+  }
+
+  template<typename T>
+  SPSCQueueRT<T>& create_spsc_queue_rt(uint32_t minCapacity) { // Capacity rounds up to a power of two
+    uint32_t capacity = next_power_of_two(minCapacity);
+    SPSCQueueRT<T>& queue = alloc<SPSCQueueRT<T>>();
+    T* elements = (T*)alloc_aligned(sizeof(T) * capacity, CACHE_LINE_SIZE);
+    queue.init(elements, capacity);
+    return queue;
+  }
+
+  template<typename T>
+  MPMCQueueRT<T>& create_mpmc_queue_rt(uint32_t minCapacity) { // Capacity rounds up to a power of two
+    uint32_t capacity = next_power_of_two(minCapacity < 2 ? 2 : minCapacity);
+    MPMCQueueRT<T>& queue = alloc<MPMCQueueRT<T>>();
+    auto* cells = (typename MPMCQueueRT<T>::Cell*)alloc_aligned(sizeof(typename MPMCQueueRT<T>::Cell) * capacity, CACHE_LINE_SIZE);
+    queue.init(cells, capacity);
+    return queue;
+  }
+
+  SlabAllocator& create_slab_allocator() {
+    SlabAllocator& slab = alloc<SlabAllocator>();
+    slab.init(*this);
+    return slab;
+  }
+
   template<typename T, uint32_t N>
   GenSparseSetCT<T, N>& create_gen_sparse_set_ct() {
     GenSparseSetCT<T, N>& genSparseSet = alloc<GenSparseSetCT<T, N>>();
@@ -1381,16 +4240,24 @@ public:
     return genSparseSet;
   }
 
-  void clear() {
+  void clear(ArenaClear mode = ArenaClear::Zero) {
     used = 0;
-    memset(memory, 0, capacity); // Sets the memory to 0
+    if (stats) record_clear();
+    if (mode == ArenaClear::Decommit) {
+      vm_decommit(memory, committed);
+      committed = 0;
+      highWater = 0;
+    } else if (mode == ArenaClear::Zero) {
+      memset(memory, 0, highWater); // Nothing past the high water mark was written
+      highWater = 0;
+    }
   }
 
-  uint32_t size() const {
+  uint64_t size() const {
     return used;
   }
 
-  uint32_t available() const {
+  uint64_t available() const {
     return capacity - used;
   }
 
@@ -1399,10 +4266,216 @@ public:
   }
 
   ~Arena() {
-    free(memory);
+    vm_release(memory, capacity);
+  }
+};
+
+// Attributes allocations in this scope to tag, e.g. { ArenaTagScope tag(reloadArena, "models"); ... }
+struct ArenaTagScope {
+  Arena& arena;
+  char previous[ArenaTagStats::tagSize];
+
+  ArenaTagScope(const ArenaTagScope&) = delete;
+  ArenaTagScope& operator=(const ArenaTagScope&) = delete;
+  ArenaTagScope(ArenaTagScope&& other) = delete;
+  ArenaTagScope& operator=(ArenaTagScope&& other) = delete;
+
+  ArenaTagScope(Arena& _arena, const char* tag) : arena(_arena), previous() {
+    if (!arena.stats) return;
+    memcpy(previous, arena.stats->currentTag, sizeof(previous));
+    snprintf(arena.stats->currentTag, sizeof(arena.stats->currentTag), "%s", tag);
+  }
+
+  ~ArenaTagScope() {
+    if (arena.stats) memcpy(arena.stats->currentTag, previous, sizeof(previous));
+  }
+};
+
+void print_arena_stats(const Arena& arena, FILE* file);
+bool write_arena_stats(const char* filePath, const Arena* const* arenas, uint32_t count);
+
+// Rewinds the arena when the scope ends, nested scratch allocations are free to release
+// e.g. { ArenaTemp temp(frameArena); Node* open = frameArena.alloc_count_raw<Node>(n); }
+struct ArenaTemp {
+  Arena& arena;
+  uint64_t mark;
+
+  ArenaTemp(const ArenaTemp&) = delete;
+  ArenaTemp& operator=(const ArenaTemp&) = delete;
+  ArenaTemp(ArenaTemp&& other) = delete;
+  ArenaTemp& operator=(ArenaTemp&& other) = delete;
+
+  explicit ArenaTemp(Arena& _arena) : arena(_arena), mark(_arena.save()) {}
+
+  ~ArenaTemp() {
+    arena.restore(mark);
   }
 };
 
+template<typename KeyType, typename ValueType>
+void GrowableHashMapRT<KeyType, ValueType>::grow() {
+  old = table;
+  migrateCursor = 0;
+  table = &arena->create_hashmap_rt<KeyType, ValueType>(old->slotCount * 2);
+}
+
+template<typename T>
+void Pool<T>::grow() {
+  LOG_ASSERT(blockCount < maxBlocks, "Pool Full!");
+  Slot* block = arena->alloc_count_raw<Slot>(blockSize);
+  uint32_t first = blockCount * blockSize;
+  for (uint32_t i = 0; i < blockSize; i++) { // Link the new block in front of the free list
+    block[i].id = first + i;
+    block[i].gen = 0;
+    block[i].live = false;
+    next_free(block[i]) = i + 1 < blockSize ? first + i + 1 : freeHead;
+  }
+  blocks[blockCount++] = block;
+  freeHead = first;
+}
+
+template<typename T, typename Handle, uint32_t PageSize>
+void PagedGenSparseSetRT<T, Handle, PageSize>::allocate_page(uint32_t page) {
+  pages[page] = arena->alloc_raw<Slot>(sizeof(Slot) * PageSize);
+  memset(pages[page], 0, sizeof(Slot) * PageSize); // Arena memory may be reused, epoch 0 marks unused slots
+}
+
+// NOTE: Sorting with scratch memory
+// Merge buffer comes from the scratch arena & is released again before returning. Elements are
+// move assigned into it, so non trivial types are constructed there first & destroyed after.
+template<typename T, typename Compare = SortLess, typename Project = SortIdentity>
+void stable_sort(T* begin, T* end, Arena& scratch, Compare comp = Compare{}, Project proj = Project{}) {
+  constexpr bool trivial = std::is_trivially_copyable_v<T>;
+  static_assert(trivial || std::is_default_constructible_v<T>, "stable_sort needs a default constructor to build its merge buffer");
+  ArenaTemp temp(scratch);
+  uint32_t half = (uint32_t)((end - begin) / 2);
+  T* buffer = half > 0 ? scratch.alloc_raw<T>(sizeof(T) * half) : nullptr;
+  if constexpr (!trivial) for (uint32_t i = 0; i < half; i++) new (buffer + i) T();
+  PdqSort::stable_sort(begin, end, buffer, comp, proj);
+  if constexpr (!trivial) for (uint32_t i = 0; i < half; i++) buffer[i].~T();
+}
+
+template<typename T, uint32_t N, typename Compare = SortLess, typename Project = SortIdentity>
+void stable_sort(ArrayCT<T, N>& arr, Arena& scratch, Compare comp = Compare{}, Project proj = Project{}) {
+  stable_sort(arr.elements, arr.elements + arr.count, scratch, comp, proj);
+}
+
+template<typename T, typename Compare = SortLess, typename Project = SortIdentity>
+void stable_sort(ArrayRT<T>& arr, Arena& scratch, Compare comp = Compare{}, Project proj = Project{}) {
+  stable_sort(arr.elements, arr.elements + arr.count, scratch, comp, proj);
+}
+
+// LSD radix sort over radix_key(proj(x)), one pass per key byte. Stable.
+// Passes where every key shares the same byte are skipped.
+template<typename T, typename Project = SortIdentity>
+void radix_sort(T* begin, T* end, Arena& scratch, Project proj = Project{}) {
+  uint32_t count = (uint32_t)(end - begin);
+  if (count < 2) return;
+  using Key = decltype(radix_key(proj(*begin)));
+  constexpr uint32_t passes = sizeof(Key);
+
+  ArenaTemp temp(scratch);
+  uint32_t* histograms = scratch.alloc_raw<uint32_t>(sizeof(uint32_t) * 256 * passes);
+  T* buffer = scratch.alloc_raw<T>(sizeof(T) * count);
+  memset(histograms, 0, sizeof(uint32_t) * 256 * passes);
+
+  for (T* it = begin; it != end; ++it) { // All histograms in one sweep
+    Key key = radix_key(proj(*it));
+    for (uint32_t pass = 0; pass < passes; pass++) histograms[pass * 256 + ((key >> (pass * 8)) & 0xFF)]++;
+  }
+
+  T* src = begin;
+  T* dst = buffer;
+  Key firstKey = radix_key(proj(*begin));
+  for (uint32_t pass = 0; pass < passes; pass++) {
+    uint32_t* offsets = histograms + pass * 256;
+    uint32_t shift = pass * 8;
+    if (offsets[(firstKey >> shift) & 0xFF] == count) continue;
+
+    uint32_t sum = 0;
+    for (uint32_t i = 0; i < 256; i++) {
+      uint32_t bucket = offsets[i];
+      offsets[i] = sum;
+      sum += bucket;
+    }
+    for (T* it = src; it != src + count; ++it) dst[offsets[(radix_key(proj(*it)) >> shift) & 0xFF]++] = std::move(*it);
+    std::swap(src, dst);
+  }
+
+  if (src != begin) {
+    for (uint32_t i = 0; i < count; i++) begin[i] = std::move(src[i]);
+  }
+}
+
+template<typename T, uint32_t N, typename Project = SortIdentity>
+void radix_sort(ArrayCT<T, N>& arr, Arena& scratch, Project proj = Project{}) {
+  radix_sort(arr.elements, arr.elements + arr.count, scratch, proj);
+}
+
+template<typename T, typename Project = SortIdentity>
+void radix_sort(ArrayRT<T>& arr, Arena& scratch, Project proj = Project{}) {
+  radix_sort(arr.elements, arr.elements + arr.count, scratch, proj);
+}
+
+constexpr uint32_t parallelSortMaxThreads = 64;
+constexpr uint32_t parallelSortMinChunk = 16384;
+
+// Sorts chunks on separate threads, then merges pairs of runs in parallel rounds.
+// threadCount 0 uses every hardware thread. Small inputs sort on the calling thread.
+template<typename T, typename Compare = SortLess, typename Project = SortIdentity>
+void parallel_sort(T* begin, T* end, Arena& scratch, Compare comp = Compare{}, Project proj = Project{}, uint32_t threadCount = 0) {
+  uint32_t count = (uint32_t)(end - begin);
+  if (threadCount == 0) threadCount = std::thread::hardware_concurrency();
+  uint32_t runs = std::min(std::min(threadCount, count / parallelSortMinChunk), parallelSortMaxThreads);
+  if (runs <= 1) {
+    PdqSort::sort(begin, end, comp, proj);
+    return;
+  }
+
+  ArenaTemp temp(scratch);
+  T* buffer = scratch.alloc_raw<T>(sizeof(T) * count);
+  uint32_t bounds[parallelSortMaxThreads + 1];
+  for (uint32_t i = 0; i <= runs; i++) bounds[i] = (uint32_t)((uint64_t)count * i / runs);
+
+  std::thread threads[parallelSortMaxThreads];
+  for (uint32_t i = 1; i < runs; i++) {
+    threads[i] = std::thread([=, &comp, &proj]() { PdqSort::sort(begin + bounds[i], begin + bounds[i + 1], comp, proj); });
+  }
+  PdqSort::sort(begin + bounds[0], begin + bounds[1], comp, proj);
+  for (uint32_t i = 1; i < runs; i++) threads[i].join();
+
+  auto less = [&](const T& a, const T& b) -> bool { return comp(proj(a), proj(b)); };
+  T* src = begin;
+  T* dst = buffer;
+  while (runs > 1) {
+    uint32_t pairs = runs / 2;
+    auto merge_pair = [=, &less](uint32_t pair) {
+      uint32_t lo = bounds[pair * 2], mid = bounds[pair * 2 + 1], hi = bounds[pair * 2 + 2];
+      PdqSort::merge(src + lo, src + mid, src + mid, src + hi, dst + lo, less);
+    };
+    for (uint32_t pair = 1; pair < pairs; pair++) threads[pair] = std::thread(merge_pair, pair);
+    merge_pair(0);
+    if (runs & 1) { // Odd run out has no partner this round
+      for (uint32_t i = bounds[runs - 1]; i < count; i++) dst[i] = std::move(src[i]);
+    }
+    for (uint32_t pair = 1; pair < pairs; pair++) threads[pair].join();
+
+    for (uint32_t i = 0; i <= runs / 2; i++) bounds[i] = bounds[i * 2];
+    if (runs & 1) bounds[pairs + 1] = count;
+    runs = pairs + (runs & 1);
+    std::swap(src, dst);
+  }
+
+  if (src != begin) {
+    for (uint32_t i = 0; i < count; i++) begin[i] = std::move(src[i]);
+  }
+}
+
+template<typename T, typename Compare = SortLess, typename Project = SortIdentity>
+void parallel_sort(ArrayRT<T>& arr, Arena& scratch, Compare comp = Compare{}, Project proj = Project{}, uint32_t threadCount = 0) {
+  parallel_sort(arr.elements, arr.elements + arr.count, scratch, comp, proj, threadCount);
+}
+
 // NOTE: Size defs
 #define KB(x) ((x) * 1024ULL)
 #define MB(x) ((x) * 1024ULL * 1024ULL)
@@ -1411,13 +4484,94 @@ public:
 // NOTE: File I/O
 uint64_t get_timestamp(const char* file);
 bool file_exists(const char* filePath);
-uint32_t get_file_size(const char* filePath);
-char* read_file(const char* filePath, Arena& arena);
+uint64_t get_file_size(const char* filePath);
+char* read_file(const char* filePath, Arena& arena); // Copies the file into the arena, null terminated
 void write_file(const char* filePath, const char* buffer, uint32_t size);
-bool copy_file(const char* fileName, const char* outputName, Arena& arena);
+bool copy_file(const char* fileName, const char* outputName);
 void remove_file(const char* fileName);
 void rename_file(const char *__old, const char *__new);
 
+// Read only memory mapped view of a whole file, nothing is copied & pages load on first touch.
+// Swap read_file for map_file where the data is only read, the view isn't null terminated.
+enum class FileAdvice {
+  Normal,
+  Sequential, // Aggressive read ahead, pages behind can be dropped early
+  Random, // No read ahead
+  WillNeed // Start reading the whole file in now
+};
+
+struct FileView {
+  const char* data = nullptr;
+  uint64_t size = 0;
+  void* mapping = nullptr; // Platform handle for the file mapping
+};
+
+bool map_file(const char* filePath, FileView& view, FileAdvice advice = FileAdvice::Normal);
+void advise_file(const FileView& view, FileAdvice advice); // No-op on Windows
+void unmap_file(FileView& view);
+
+struct FileViewScope {
+  FileView view;
+  bool mapped;
+
+  FileViewScope(const FileViewScope&) = delete;
+  FileViewScope& operator=(const FileViewScope&) = delete;
+  FileViewScope(FileViewScope&& other) = delete;
+  FileViewScope& operator=(FileViewScope&& other) = delete;
+
+  explicit FileViewScope(const char* filePath, FileAdvice advice = FileAdvice::Normal) : mapped(map_file(filePath, view, advice)) {}
+  ~FileViewScope() { unmap_file(view); }
+};
+
+// NOTE: Async file I/O
+// Batches of reads & writes complete off the calling thread, on io_uring where the kernel has it &
+// on worker threads doing pread/pwrite otherwise. Requests & their buffers belong to the caller,
+// e.g. allocated from an Arena, & must stay put until handed back. Submit, poll & wait from one
+// thread, completions are handed back inside async_io_poll/async_io_wait on that thread, so
+// callbacks can touch game state without locking.
+enum class IoOp : uint8_t {
+  Read,
+  Write
+};
+
+enum class IoStatus : uint8_t {
+  Idle,
+  Pending,
+  Done,
+  Failed
+};
+
+enum class IoBackend : uint8_t {
+  Uring,
+  Workers
+};
+
+struct IoRequest {
+  IoOp op = IoOp::Read;
+  int fd = -1; // Used when path is null
+  const char* path = nullptr; // Opened for the request & closed when it completes, writes create the file
+  uint64_t offset = 0;
+  uint64_t size = 0;
+  char* buffer = nullptr; // Destination for reads, source for writes
+  void (*callback)(IoRequest& request) = nullptr; // Optional, runs when the request is handed back
+  void* user = nullptr;
+  std::atomic<IoStatus> status{IoStatus::Idle}; // Changes to Done/Failed when the request is handed back
+  int64_t result = 0; // Bytes transferred, short only at end of file, or -errno
+  uint64_t transferred = 0; // Service bookkeeping, short transfers are resumed
+  int openedFd = -1;
+};
+
+struct AsyncIo;
+
+// Falls back to workers when io_uring is unavailable (not Linux, old kernel or blocked by seccomp)
+AsyncIo* async_io_create(uint32_t queueDepth = 256, uint32_t workerCount = 2, IoBackend preferred = IoBackend::Uring);
+void async_io_destroy(AsyncIo* io); // Waits for everything in flight first
+IoBackend async_io_backend(const AsyncIo& io);
+void async_io_submit(AsyncIo& io, IoRequest* requests, uint32_t count); // Waits for room once queueDepth requests are in flight
+uint32_t async_io_poll(AsyncIo& io); // Hands back finished requests without blocking, returns how many
+void async_io_wait(AsyncIo& io, IoRequest& request);
+void async_io_wait_all(AsyncIo& io);
+
 // NOTE: Testing
 bool CompareFloat(float a, float b, float epsilon = 0.0001f);
 bool CompareIntArrays(const int *a, const int *b, uint32_t size);
@@ -1426,5 +4580,186 @@ bool CompareUCharArrays(const unsigned char *a, const unsigned char *b, uint32_t
 bool CompareUIntArrays(const unsigned int *a, const unsigned int *b, uint32_t size);
 bool CompareUShortArrays(const unsigned short *a, const unsigned short *b, uint32_t size);
 
+// NOTE: Benchmarking
+// Timed with the calibrated cycle counter. After a warmup the iterations per sample double until
+// a sample is long enough to hide the timer overhead, then samples are taken for min/median/p99.
+// e.g. suite.run("sort", [&]() { sort(arr); do_not_optimize(arr.elements[0]); });
+template<typename T>
+inline void do_not_optimize(const T& value) { // Forces value to be computed & kept
+#if defined(_MSC_VER)
+  const volatile char* sink = (const volatile char*)&value;
+  (void)*sink;
+  _ReadWriteBarrier();
+#else
+  asm volatile("" : : "r,m"(value) : "memory");
+#endif
+}
+
+inline void clobber_memory() { // Forces pending writes out to memory
+#if defined(_MSC_VER)
+  _ReadWriteBarrier();
+#else
+  asm volatile("" : : : "memory");
+#endif
+}
+
+struct BenchmarkConfig {
+  double warmupMs = 20.0;
+  double minSampleUs = 200.0;
+  uint32_t samples = 31;
+  double maxSeconds = 2.0; // Slow benchmarks stop sampling early, after at least 3 samples
+  bool paramIsItems = false; // Also report time per item, param being the items one iteration processes
+};
+
+enum PerfCounter {
+  PERF_CYCLES,
+  PERF_INSTRUCTIONS,
+  PERF_L1D_MISSES,
+  PERF_LLC_MISSES,
+  PERF_BRANCH_MISSES,
+  PERF_DTLB_MISSES,
+  PERF_COUNTER_COUNT
+};
+
+extern const char* PerfCounterNames[PERF_COUNTER_COUNT];
+
+// Hardware counters for the calling thread (user space only) through perf_event_open on Linux.
+// Counters the kernel or CPU refuses are skipped, elsewhere open() just returns false.
+struct PerfCounters {
+  int fds[PERF_COUNTER_COUNT];
+  uint32_t mask = 0; // Bit per open counter
+
+  PerfCounters() { for (int& fd : fds) fd = -1; }
+  ~PerfCounters() { close(); }
+
+  PerfCounters(const PerfCounters&) = delete;
+  PerfCounters& operator=(const PerfCounters&) = delete;
+  PerfCounters(PerfCounters&&) = delete;
+  PerfCounters& operator=(PerfCounters&&) = delete;
+
+  bool open();
+  void close();
+  void read(uint64_t* values) const; // Running totals, scaled up when the kernel had to multiplex
+};
+
+struct BenchmarkResult {
+  char name[64];
+  uint64_t param;
+  uint64_t iterations; // Per sample
+  uint32_t samples;
+  double minNs; // Per iteration
+  double medianNs;
+  double p99Ns;
+  double meanNs;
+  double stddevNs;
+  uint32_t counterMask; // Which counters were measured
+  double counters[PERF_COUNTER_COUNT]; // Per iteration, averaged over every sample
+};
+
+double benchmark_ticks_per_ns(); // Calibrated against steady_clock on first use
+void benchmark_stats(double* samplesNs, uint32_t count, BenchmarkResult& result); // Sorts samplesNs
+
+struct BenchmarkSuite {
+  static constexpr uint32_t maxSamples = 1024;
+  Arena arena;
+  ArrayRT<BenchmarkResult>& results;
+  BenchmarkConfig config;
+  const char* filter = nullptr; // Only names containing this run
+  double samplesNs[maxSamples];
+  PerfCounters perf;
+  bool countersEnabled = false;
+  uint64_t counterTotals[PERF_COUNTER_COUNT];
+
+  BenchmarkSuite(uint32_t maxResults = 1024)
+    : arena(maxResults * sizeof(BenchmarkResult) + KB(64))
+    , results(arena.create_array_rt<BenchmarkResult>(maxResults)) {}
+
+  BenchmarkSuite(const BenchmarkSuite&) = delete;
+  BenchmarkSuite& operator=(const BenchmarkSuite&) = delete;
+  BenchmarkSuite(BenchmarkSuite&&) = delete;
+  BenchmarkSuite& operator=(BenchmarkSuite&&) = delete;
+
+  template<typename Fn>
+  const BenchmarkResult* run(const char* name, Fn&& fn) {
+    return measure<false>(name, 0, [](uint64_t) {}, [&](uint64_t) { fn(); });
+  }
+
+  // param only labels the result, e.g. the size of a container built beforehand
+  template<typename Fn>
+  const BenchmarkResult* run(const char* name, uint64_t param, Fn&& fn) {
+    return measure<false>(name, param, [](uint64_t) {}, [&](uint64_t) { fn(); });
+  }
+
+  // fn(param) once per param, e.g. container sizes
+  template<typename Fn>
+  void run_params(const char* name, const uint64_t* params, uint32_t count, Fn&& fn) {
+    for (uint32_t i = 0; i < count; i++) measure<false>(name, params[i], [](uint64_t) {}, fn);
+  }
+
+  // setup(param) runs untimed before every call, e.g. clearing the caches. Each call is then its own
+  // sample, so fn should take microseconds or more.
+  template<typename Setup, typename Fn>
+  const BenchmarkResult* run_with_setup(const char* name, uint64_t param, Setup&& setup, Fn&& fn) {
+    return measure<true>(name, param, setup, fn);
+  }
+
+  // Reads hardware counters around every sample, returns false & keeps timing only when none open
+  bool enable_counters() {
+    countersEnabled = perf.open();
+    return countersEnabled;
+  }
+
+  bool write_json(const char* path) const;
+  bool write_csv(const char* path) const;
+  // Compares medians against a CSV written by write_csv, returns how many got slower by more than threshold
+  uint32_t compare_baseline(const char* path, double threshold = 0.1) const;
+
+private:
+  template<bool HasSetup, typename Setup, typename Fn>
+  const BenchmarkResult* measure(const char* name, uint64_t param, Setup&& setup, Fn&& fn) {
+    if (filter && !strstr(name, filter)) return nullptr;
+    double ticksPerNs = benchmark_ticks_per_ns();
+    uint64_t warmupEnd = read_cycle_counter() + (uint64_t)(config.warmupMs * 1e6 * ticksPerNs);
+    do {
+      setup(param);
+      fn(param);
+    } while (read_cycle_counter() < warmupEnd);
+
+    uint64_t iterations = 1;
+    uint64_t countersBefore[PERF_COUNTER_COUNT];
+    uint64_t countersAfter[PERF_COUNTER_COUNT];
+    auto time_sample = [&](bool counted) -> uint64_t {
+      if constexpr (HasSetup) setup(param);
+      if (counted) perf.read(countersBefore);
+      clobber_memory();
+      uint64_t start = read_cycle_counter();
+      for (uint64_t i = 0; i < iterations; i++) fn(param);
+      clobber_memory();
+      uint64_t ticks = read_cycle_counter() - start;
+      if (counted) {
+        perf.read(countersAfter);
+        for (uint32_t c = 0; c < PERF_COUNTER_COUNT; c++) counterTotals[c] += countersAfter[c] - countersBefore[c];
+      }
+      return ticks;
+    };
+
+    if constexpr (!HasSetup) {
+      uint64_t minSampleTicks = (uint64_t)(config.minSampleUs * 1e3 * ticksPerNs);
+      while (time_sample(false) < minSampleTicks && iterations < (1ull << 40)) iterations *= 2;
+    }
+
+    uint32_t sampleCount = config.samples < maxSamples ? config.samples : maxSamples;
+    uint64_t deadline = read_cycle_counter() + (uint64_t)(config.maxSeconds * 1e9 * ticksPerNs);
+    uint32_t count = 0;
+    memset(counterTotals, 0, sizeof(counterTotals));
+    while (count < sampleCount && (count < 3 || read_cycle_counter() < deadline)) {
+      samplesNs[count++] = (double)time_sample(countersEnabled) / ticksPerNs / (double)iterations;
+    }
+    return finish(name, param, iterations, count);
+  }
+
+  const BenchmarkResult* finish(const char* name, uint64_t param, uint64_t iterations, uint32_t count);
+};
+
 // NOTE: Direct std:: replacements
 float Clamp(float value, float min, float max);
@@ -1,12 +1,14 @@
 #include "utils.h"
 #include "utils_test.h"
 
-// g++ utils_benchmark.cpp utils.cpp utils_test.cpp -O0 -g -o utils_benchmark
+// Built by the utils_benchmark target in client/CMakeLists.txt, always optimized
+// g++ utils_benchmark.cpp utils.cpp utils_test.cpp -O3 -march=native -o utils_benchmark
+// Usage: utils_benchmark [--cache none|thorough|stride|random|all] [--filter name] [--json out.json]
+//                        [--csv out.csv] [--baseline baseline.csv] [--threshold 0.1] [--counters]
 
 const size_t CACHE_SIZE = MB(1); // 1MB for quick methods
 const size_t FULL_CACHE_SIZE = MB(4); // 4MB for thorough method
 const size_t STRIDE = 64;
-const int ITERATIONS = 100;
 
 constexpr size_t THOROUGH_ARRAY_SIZE = FULL_CACHE_SIZE / sizeof(int);
 constexpr size_t QUICK_ARRAY_SIZE = CACHE_SIZE / sizeof(int);
@@ -58,148 +60,106 @@ void clear_cache_random() {
   }
 }
 
-void run_iterator_tests(CacheClearMethod method) {
-  printf("\n=== Iterator Tests (Cache: %s) ===\n",
-         method == CacheClearMethod::Thorough ? "Thorough" :
-         method == CacheClearMethod::Stride ? "Stride" :
-         method == CacheClearMethod::Random ? "Random" : "None");
-
-  auto run_ct_test = [method]() {
-    if (method == CacheClearMethod::Thorough) clear_cache_thorough();
-    else if (method == CacheClearMethod::Stride) clear_cache_stride();
-    else if (method == CacheClearMethod::Random) clear_cache_random();
-    iterators_arrays_CT_test();
-  };
-  printf("  CT Array Iterator Test: ");
-  BENCHMARK(run_ct_test, ITERATIONS);
-
-  auto run_rt_test = [method]() {
-    if (method == CacheClearMethod::Thorough) clear_cache_thorough();
-    else if (method == CacheClearMethod::Stride) clear_cache_stride();
-    else if (method == CacheClearMethod::Random) clear_cache_random();
-    iterators_arrays_RT_test();
-  };
-  printf("  RT Array Iterator Test: ");
-  BENCHMARK(run_rt_test, ITERATIONS);
+const char* cache_clear_name(CacheClearMethod method) {
+  return method == CacheClearMethod::Thorough ? "thorough" :
+         method == CacheClearMethod::Stride ? "stride" :
+         method == CacheClearMethod::Random ? "random" : "none";
 }
 
-void run_arena_tests(CacheClearMethod method) {
-  printf("\n=== Arena Tests (Cache: %s) ===\n",
-         method == CacheClearMethod::Thorough ? "Thorough" :
-         method == CacheClearMethod::Stride ? "Stride" :
-         method == CacheClearMethod::Random ? "Random" : "None");
-
-  auto run_ct_arena = [method]() {
-    if (method == CacheClearMethod::Thorough) clear_cache_thorough();
-    else if (method == CacheClearMethod::Stride) clear_cache_stride();
-    else if (method == CacheClearMethod::Random) clear_cache_random();
-    create_and_fetch_arena_in_different_scope_CT_test();
-  };
-  printf("  Arena CT Create/Fetch Test: ");
-  BENCHMARK(run_ct_arena, ITERATIONS);
-
-  auto run_rt_arena = [method]() {
-    if (method == CacheClearMethod::Thorough) clear_cache_thorough();
-    else if (method == CacheClearMethod::Stride) clear_cache_stride();
-    else if (method == CacheClearMethod::Random) clear_cache_random();
-    create_and_fetch_arena_in_different_scope_RT_test();
-  };
-  printf("  Arena RT Create/Fetch Test: ");
-  BENCHMARK(run_rt_arena, ITERATIONS);
-
-  auto run_clear = [method]() {
-    if (method == CacheClearMethod::Thorough) clear_cache_thorough();
-    else if (method == CacheClearMethod::Stride) clear_cache_stride();
-    else if (method == CacheClearMethod::Random) clear_cache_random();
-    create_arena_clear_test();
-  };
-  printf("  Arena Clear Test: ");
-  BENCHMARK(run_clear, ITERATIONS);
-
-  auto run_ct_hashmap = [method]() {
-    if (method == CacheClearMethod::Thorough) clear_cache_thorough();
-    else if (method == CacheClearMethod::Stride) clear_cache_stride();
-    else if (method == CacheClearMethod::Random) clear_cache_random();
-    create_hashmap_in_arena_CT_test();
-  };
-  printf("  Arena CT Hashmap Test: ");
-  BENCHMARK(run_ct_hashmap, ITERATIONS);
-
-  auto run_rt_hashmap = [method]() {
-    if (method == CacheClearMethod::Thorough) clear_cache_thorough();
-    else if (method == CacheClearMethod::Stride) clear_cache_stride();
-    else if (method == CacheClearMethod::Random) clear_cache_random();
-    create_hashmap_in_arena_RT_test();
-  };
-  printf("  Arena RT Hashmap Test: ");
-  BENCHMARK(run_rt_hashmap, ITERATIONS);
-
-  auto run_ct_sparse_set = [method]() {
-    if (method == CacheClearMethod::Thorough) clear_cache_thorough();
-    else if (method == CacheClearMethod::Stride) clear_cache_stride();
-    else if (method == CacheClearMethod::Random) clear_cache_random();
-    gen_sparse_set_ct_test();
-  };
-  printf("  Arena CT Sparse Set Test: ");
-  BENCHMARK(run_ct_sparse_set, ITERATIONS);
-
-  auto run_rt_sparse_set = [method]() {
-    if (method == CacheClearMethod::Thorough) clear_cache_thorough();
-    else if (method == CacheClearMethod::Stride) clear_cache_stride();
-    else if (method == CacheClearMethod::Random) clear_cache_random();
-    gen_sparse_set_rt_test();
-  };
-  printf("  Arena RT Sparse Set Test: ");
-  BENCHMARK(run_rt_sparse_set, ITERATIONS);
+void clear_cache(CacheClearMethod method) {
+  if (method == CacheClearMethod::Thorough) clear_cache_thorough();
+  else if (method == CacheClearMethod::Stride) clear_cache_stride();
+  else if (method == CacheClearMethod::Random) clear_cache_random();
 }
 
-void run_sort_tests(CacheClearMethod method) {
-  printf("\n=== Sort Tests (Cache: %s) ===\n",
-         method == CacheClearMethod::Thorough ? "Thorough" :
-         method == CacheClearMethod::Stride ? "Stride" :
-         method == CacheClearMethod::Random ? "Random" : "None");
-
-  auto run_sort = [method]() {
-    if (method == CacheClearMethod::Thorough) clear_cache_thorough();
-    else if (method == CacheClearMethod::Stride) clear_cache_stride();
-    else if (method == CacheClearMethod::Random) clear_cache_random();
-    quicksort_test();
-  };
-  printf("  Sort Test: ");
-  BENCHMARK(run_sort, ITERATIONS);
+// Cache clearing runs untimed before every call, without it the calls are batched
+template<typename Fn>
+void run_benchmark(BenchmarkSuite& suite, CacheClearMethod method, const char* name, Fn&& fn) {
+  char fullName[64];
+  snprintf(fullName, sizeof(fullName), "%s [%s]", name, cache_clear_name(method));
+  if (method == CacheClearMethod::None) {
+    suite.run(fullName, fn);
+  } else {
+    suite.run_with_setup(fullName, 0, [method](uint64_t) { clear_cache(method); }, [&](uint64_t) { fn(); });
+  }
 }
 
-void run_file_io_tests(CacheClearMethod method) {
-  printf("\n=== File I/O Tests (Cache: %s) ===\n",
-         method == CacheClearMethod::Thorough ? "Thorough" :
-         method == CacheClearMethod::Stride ? "Stride" :
-         method == CacheClearMethod::Random ? "Random" : "None");
-
-  auto run_io = [method]() {
-    if (method == CacheClearMethod::Thorough) clear_cache_thorough();
-    else if (method == CacheClearMethod::Stride) clear_cache_stride();
-    else if (method == CacheClearMethod::Random) clear_cache_random();
-    file_io_test();
-  };
-  printf("  File I/O Operations Test: ");
-  BENCHMARK(run_io, ITERATIONS);
+void run_iterator_tests(BenchmarkSuite& suite, CacheClearMethod method) {
+  printf("\n=== Iterator Tests (Cache: %s) ===\n", cache_clear_name(method));
+  run_benchmark(suite, method, "CT Array Iterator", iterators_arrays_CT_test);
+  run_benchmark(suite, method, "RT Array Iterator", iterators_arrays_RT_test);
 }
 
-void run_all_tests(CacheClearMethod method) {
-  run_iterator_tests(method);
-  run_arena_tests(method);
-  run_file_io_tests(method);
-  run_sort_tests(method);
+void run_arena_tests(BenchmarkSuite& suite, CacheClearMethod method) {
+  printf("\n=== Arena Tests (Cache: %s) ===\n", cache_clear_name(method));
+  run_benchmark(suite, method, "Arena CT Create/Fetch", create_and_fetch_arena_in_different_scope_CT_test);
+  run_benchmark(suite, method, "Arena RT Create/Fetch", create_and_fetch_arena_in_different_scope_RT_test);
+  run_benchmark(suite, method, "Arena Clear", create_arena_clear_test);
+  run_benchmark(suite, method, "Arena CT Hashmap", create_hashmap_in_arena_CT_test);
+  run_benchmark(suite, method, "Arena RT Hashmap", create_hashmap_in_arena_RT_test);
+  run_benchmark(suite, method, "Arena CT Sparse Set", gen_sparse_set_ct_test);
+  run_benchmark(suite, method, "Arena RT Sparse Set", gen_sparse_set_rt_test);
 }
 
-int main(int argc, char *argv[]) {
-  printf("Running performance tests with different cache clearing methods...\n");
+void run_sort_tests(BenchmarkSuite& suite, CacheClearMethod method) {
+  printf("\n=== Sort Tests (Cache: %s) ===\n", cache_clear_name(method));
+  run_benchmark(suite, method, "Sort", quicksort_test);
+}
 
-  run_all_tests(CacheClearMethod::None);
-  run_all_tests(CacheClearMethod::Thorough);
-  run_all_tests(CacheClearMethod::Stride);
-  run_all_tests(CacheClearMethod::Random);
+void run_file_io_tests(BenchmarkSuite& suite, CacheClearMethod method) {
+  printf("\n=== File I/O Tests (Cache: %s) ===\n", cache_clear_name(method));
+  run_benchmark(suite, method, "File I/O Operations", file_io_test);
+}
 
-  return 0;
+void run_all_tests(BenchmarkSuite& suite, CacheClearMethod method) {
+  run_iterator_tests(suite, method);
+  run_arena_tests(suite, method);
+  run_file_io_tests(suite, method);
+  run_sort_tests(suite, method);
 }
 
+int main(int argc, char *argv[]) {
+  const char* cache = "all";
+  const char* jsonPath = nullptr;
+  const char* csvPath = nullptr;
+  const char* baselinePath = nullptr;
+  double threshold = 0.1;
+  BenchmarkSuite suite;
+
+  bool counters = false;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--counters") == 0) {
+      counters = true;
+      continue;
+    }
+    if (i + 1 >= argc) {
+      LOG_WARN("Missing value for %s", argv[i]);
+      break;
+    }
+    if (strcmp(argv[i], "--cache") == 0) cache = argv[i + 1];
+    else if (strcmp(argv[i], "--filter") == 0) suite.filter = argv[i + 1];
+    else if (strcmp(argv[i], "--json") == 0) jsonPath = argv[i + 1];
+    else if (strcmp(argv[i], "--csv") == 0) csvPath = argv[i + 1];
+    else if (strcmp(argv[i], "--baseline") == 0) baselinePath = argv[i + 1];
+    else if (strcmp(argv[i], "--threshold") == 0) threshold = atof(argv[i + 1]);
+    else LOG_WARN("Unknown option %s", argv[i]);
+    i++;
+  }
+
+  logDefault.set_level(LogLevel::Warn); // The tests log every pass, that would be measured too
+  printf("Running benchmarks (timer %.3f ticks/ns)...\n", benchmark_ticks_per_ns());
+  if (counters && !suite.enable_counters()) {
+    LOG_WARN("Hardware counters unavailable (not Linux, no PMU or perf_event_paranoid too high), timing only");
+  }
+
+  const CacheClearMethod methods[] = {CacheClearMethod::None, CacheClearMethod::Thorough, CacheClearMethod::Stride, CacheClearMethod::Random};
+  for (CacheClearMethod method : methods) {
+    if (strcmp(cache, "all") == 0 || strcmp(cache, cache_clear_name(method)) == 0) run_all_tests(suite, method);
+  }
+
+  if (jsonPath) suite.write_json(jsonPath);
+  if (csvPath) suite.write_csv(csvPath);
+  uint32_t regressions = baselinePath ? suite.compare_baseline(baselinePath, threshold) : 0;
+  if (regressions) LOG_ERROR("%u benchmarks regressed beyond %.0f%%", regressions, threshold * 100.0);
+  return regressions ? 1 : 0;
+}
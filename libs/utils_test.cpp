@@ -58,11 +58,11 @@ void iterators_arrays_RT_test() {
 
 void create_and_fetch_arena_in_different_scope_CT_test() {
   const char* failedMsg = "[ FAILED ] create_and_fetch_arena_in_different_scope_CT_test";
-  Arena& arena = *new Arena(80);
-  MapCT<const char*, void*, 1>& arenaIndex = arena.create_map_ct<const char*, void*, 1>();
+  Arena& arena = *new Arena(KB(1));
+  ArenaIndexCT<2>& arenaIndex = arena.create_arena_index_ct<2>();
   {
     ArrayCT<Entity, 3>& entitiesArray = arena.create_array_ct<Entity, 3>();
-    arenaIndex["entities"] = &entitiesArray;
+    arenaIndex.set(SYMBOL("entities"), arena.offset_of(&entitiesArray));
 
     // Create an array of entities
     Entity entities[] = {
@@ -76,7 +76,7 @@ void create_and_fetch_arena_in_different_scope_CT_test() {
   }
   {
     // Access entities from the array from scratch
-    ArrayCT<Entity, 3>& entitiesFetched = arena.fetch<ArrayCT<Entity, 3>, MapCT<const char*, void*, 1>>("entities");
+    ArrayCT<Entity, 3>& entitiesFetched = arena.fetch<ArrayCT<Entity, 3>, ArenaIndexCT<2>>(SYMBOL("entities"));
 
     // Access entities
     Entity e0 = entitiesFetched[0];
@@ -94,11 +94,11 @@ void create_and_fetch_arena_in_different_scope_CT_test() {
 
 void create_and_fetch_arena_in_different_scope_RT_test() {
   const char* failedMsg = "[ FAILED ] create_and_fetch_arena_in_different_scope_RT_test";
-  Arena& arena = *new Arena(88); //NOTE: 8 more bytes than CT... 2x extra 32 bit int for size...
-  MapRT<const char*, void*>& arenaIndex = arena.create_map_rt<const char*, void*>(1);
+  Arena& arena = *new Arena(KB(1));
+  ArenaIndexCT<2>& arenaIndex = arena.create_arena_index_ct<2>();
   {
     ArrayRT<Entity>& entitiesArray = arena.create_array_rt<Entity>(3);
-    arenaIndex["entities"] = &entitiesArray;
+    arenaIndex.set(SYMBOL("entities"), arena.offset_of(&entitiesArray));
 
     // Create an array of entities
     Entity entities[] = {
@@ -112,7 +112,7 @@ void create_and_fetch_arena_in_different_scope_RT_test() {
   }
   {
     // Access entities from the array from scratch
-    ArrayRT<Entity>& entitiesFetched = arena.fetch<ArrayRT<Entity>, MapRT<const char*, void*>>("entities");
+    ArrayRT<Entity>& entitiesFetched = arena.fetch<ArrayRT<Entity>, ArenaIndexCT<2>>(SYMBOL("entities"));
 
     // Access entities
     Entity e0 = entitiesFetched[0];
@@ -128,14 +128,52 @@ void create_and_fetch_arena_in_different_scope_RT_test() {
   LOG_TRACE("[ PASSED ] create_and_fetch_arena_in_different_scope_RT_test")
 }
 
+void arena_index_test() {
+  const char* failedMsg = "[ FAILED ] arena_index_test";
+  Arena& arena = *new Arena(KB(4));
+  using Index = ArenaIndexCT<16>;
+  Index& index = arena.create_arena_index_ct<16>();
+  {
+    ArrayCT<Entity, 3>& entitiesArray = arena.create_array_ct<Entity, 3>();
+    entitiesArray.add(Entity{1, "Entity 1"});
+    index.set(SYMBOL("entities"), arena.offset_of(&entitiesArray));
+
+    int& counter = arena.alloc<int>();
+    counter = 42;
+    index.set(SYMBOL("counter"), arena.offset_of(&counter));
+  }
+  {
+    static_assert(SYMBOL("entities").hash == symbol_hash("entities"), "Symbols must hash at compile time");
+
+    ArrayCT<Entity, 3>& entitiesFetched = arena.fetch<ArrayCT<Entity, 3>, Index>(SYMBOL("entities"));
+    LOG_ASSERT(entitiesFetched.size() == 1 && entitiesFetched[0].id == 1, failedMsg);
+
+    // Names built at runtime resolve to the same slot
+    char name[16];
+    sprintf(name, "count%s", "er");
+    int& counterFetched = arena.fetch<int, Index>(Symbol(name));
+    LOG_ASSERT(counterFetched == 42, failedMsg);
+    int& counterLiteral = arena.fetch<int, Index>("counter"); // Plain literals convert to Symbol
+    LOG_ASSERT(&counterLiteral == &counterFetched, failedMsg);
+    LOG_ASSERT(!index.contains(SYMBOL("missing")) && index.size() == 2, failedMsg);
+  }
+
+  // All zero memory is a valid empty index, so a cleared arena can be reused as is
+  arena.clear();
+  LOG_ASSERT(reinterpret_cast<Index*>(arena.memory)->empty(), failedMsg);
+
+  delete &arena;
+  LOG_TRACE("[ PASSED ] arena_index_test")
+}
+
 void create_hashmap_in_arena_CT_test() {
   const char* failedMsg = "[ FAILED ] create_hashmap_in_arena_CT_test";
   Arena& arena = *new Arena(KB(4));
-  auto& arena_index = arena.create_hashmap_ct<const char*, void*, 1>();
+  auto& arena_index = arena.create_arena_index_ct<2>();
 
   // Create hashmap and test basic operations
   auto& map = arena.create_hashmap_ct<const char*, int, 16>();
-  arena_index["map"] = &map;
+  arena_index.set(SYMBOL("map"), arena.offset_of(&map));
 
   // Test empty state
   LOG_ASSERT(map.empty() && map.size() == 0, failedMsg);
@@ -146,7 +184,7 @@ void create_hashmap_in_arena_CT_test() {
 
   LOG_ASSERT(map.size() == 2, failedMsg);
 
-  auto& map_fetched = arena.fetch<HashMapCT<const char*, int, 16>, HashMapCT<const char*, void*, 1>>("map");
+  auto& map_fetched = arena.fetch<HashMapCT<const char*, int, 16>, ArenaIndexCT<2>>(SYMBOL("map"));
   LOG_ASSERT(map_fetched["test1"] == 42, failedMsg);
 
   // Test retrieval
@@ -193,11 +231,11 @@ void create_hashmap_in_arena_CT_test() {
 void create_hashmap_in_arena_RT_test() {
   const char* failedMsg = "[ FAILED ] create_hashmap_in_arena_CT_test";
   Arena& arena = *new Arena(KB(4));
-  auto& arena_index = arena.create_hashmap_rt<const char*, void*>(1);
+  auto& arena_index = arena.create_arena_index_ct<2>();
 
   // Create hashmap and test basic operations
   auto& map = arena.create_hashmap_rt<const char*, int>(16);
-  arena_index["map"] = &map;
+  arena_index.set(SYMBOL("map"), arena.offset_of(&map));
 
   // Test empty state
   LOG_ASSERT(map.empty() && map.size() == 0, failedMsg);
@@ -208,7 +246,7 @@ void create_hashmap_in_arena_RT_test() {
 
   LOG_ASSERT(map.size() == 2, failedMsg);
 
-  auto& map_fetched = arena.fetch<HashMapRT<const char*, int>, HashMapRT<const char*, void*>>("map");
+  auto& map_fetched = arena.fetch<HashMapRT<const char*, int>, ArenaIndexCT<2>>(SYMBOL("map"));
   LOG_ASSERT(map_fetched["test1"] == 42, failedMsg);
 
   // Test retrieval
@@ -243,6 +281,189 @@ void create_hashmap_in_arena_RT_test() {
   LOG_TRACE("[ PASSED ] create_hashmap_in_arena_RT_test")
 }
 
+void hashmap_churn_test() {
+  const char* failedMsg = "[ FAILED ] hashmap_churn_test";
+  Arena& arena = *new Arena(KB(8));
+  auto& mapCT = arena.create_hashmap_ct<const char*, int, 64>();
+  auto& mapRT = arena.create_hashmap_rt<const char*, int>(64);
+
+  char keys[40][8];
+  for (int i = 0; i < 40; i++) {
+    sprintf(keys[i], "key%d", i);
+    mapCT[keys[i]] = i;
+    mapRT[keys[i]] = i;
+  }
+
+  // Repeatedly remove & re-add so tombstones spread over every group
+  for (int round = 0; round < 50; round++) {
+    for (int i = round % 2; i < 40; i += 2) {
+      mapCT.remove(keys[i]);
+      mapRT.remove(keys[i]);
+    }
+    LOG_ASSERT(mapCT.size() == 20 && mapRT.size() == 20, failedMsg);
+    for (int i = round % 2; i < 40; i += 2) {
+      LOG_ASSERT(!mapCT.contains(keys[i]) && !mapRT.contains(keys[i]), failedMsg);
+      mapCT[keys[i]] = i + round;
+      mapRT[keys[i]] = i + round;
+    }
+    LOG_ASSERT(mapCT.size() == 40 && mapRT.size() == 40, failedMsg);
+  }
+
+  // Rehashing in place must keep every entry reachable
+  mapCT.purge_dead();
+  mapRT.purge_dead();
+  LOG_ASSERT(mapCT.dead == 0 && mapRT.dead == 0, failedMsg);
+  for (int i = 0; i < 40; i++) {
+    LOG_ASSERT(mapCT.contains(keys[i]) && mapRT.contains(keys[i]), failedMsg);
+  }
+
+  // Misses must terminate even when no group has an empty slot left
+  for (int i = 0; i < 100; i++) {
+    char miss[16];
+    sprintf(miss, "miss%d", i);
+    LOG_ASSERT(!mapCT.contains(miss) && !mapRT.contains(miss), failedMsg);
+  }
+
+  int count = 0;
+  for (auto& entry : mapCT) {
+    LOG_ASSERT(mapRT.contains(entry.key) && mapRT[entry.key] == entry.value, failedMsg);
+    count++;
+  }
+  LOG_ASSERT(count == 40, failedMsg);
+
+  delete &arena;
+  LOG_TRACE("[ PASSED ] hashmap_churn_test")
+}
+
+void growable_hashmap_test() {
+  const char* failedMsg = "[ FAILED ] growable_hashmap_test";
+  Arena& arena = *new Arena(MB(1));
+  auto& map = arena.create_growable_hashmap_rt<const char*, int>(16);
+  LOG_ASSERT(map.empty() && map.capacity() == 16, failedMsg);
+
+  // Grow well past the initial size, every key must stay reachable mid-migration
+  static char keys[2000][8];
+  bool sawMigration = false;
+  for (int i = 0; i < 2000; i++) {
+    sprintf(keys[i], "key%d", i);
+    map[keys[i]] = i;
+    sawMigration |= map.is_migrating();
+    LOG_ASSERT(map.contains(keys[i / 2]) && map[keys[i / 2]] == i / 2, failedMsg);
+  }
+  LOG_ASSERT(sawMigration && map.size() == 2000 && map.capacity() >= 2048, failedMsg);
+
+  // Churn at a steady size, tombstones must be purged without growing the table
+  uint32_t capacity = map.capacity();
+  for (int round = 0; round < 20; round++) {
+    for (int i = 1000; i < 2000; i++) map.remove(keys[i]);
+    LOG_ASSERT(map.size() == 1000, failedMsg);
+    for (int i = 1000; i < 2000; i++) map[keys[i]] = i;
+  }
+  LOG_ASSERT(map.capacity() == capacity && map.size() == 2000, failedMsg);
+
+  int count = 0;
+  int64_t sum = 0;
+  for (auto& entry : map) {
+    sum += entry.value;
+    count++;
+  }
+  LOG_ASSERT(count == 2000 && sum == 1999 * 2000 / 2, failedMsg);
+
+  map.clear();
+  LOG_ASSERT(map.empty() && !map.contains(keys[0]), failedMsg);
+
+  delete &arena;
+  LOG_TRACE("[ PASSED ] growable_hashmap_test")
+}
+
+void hashing_test() {
+  const char* failedMsg = "[ FAILED ] hashing_test";
+
+  // Strings hash by content, not by pointer, & every length path is hit
+  char buffer[128];
+  char reference[128];
+  memset(reference, 'a', sizeof(reference));
+  for (uint32_t len = 0; len < sizeof(buffer); len++) {
+    memset(buffer, 'a', len);
+    buffer[len] = '\0';
+    LOG_ASSERT(Hash<const char*>{}(buffer) == hash_bytes(reference, len), failedMsg);
+    if (len > 0) {
+      LOG_ASSERT(hash_bytes(buffer, len) != hash_bytes(buffer, len - 1), failedMsg);
+    }
+  }
+  LOG_ASSERT(hash_bytes("key", 3, 1) != hash_bytes("key", 3, 2), failedMsg);
+
+  // Low bits pick the tag, high bits pick the group, both must spread sequential keys
+  uint32_t lowBuckets[64] = {};
+  uint32_t highBuckets[64] = {};
+  for (uint32_t i = 0; i < 4096; i++) {
+    uint64_t hash = Hash<uint32_t>{}(i);
+    lowBuckets[hash & 63]++;
+    highBuckets[hash >> 58]++;
+  }
+  for (uint32_t i = 0; i < 64; i++) {
+    LOG_ASSERT(lowBuckets[i] > 32 && lowBuckets[i] < 96, failedMsg);
+    LOG_ASSERT(highBuckets[i] > 32 && highBuckets[i] < 96, failedMsg);
+  }
+
+  // Enums, GenIds & padding free structs
+  enum class Team : uint8_t { Red, Blue };
+  struct Cell { int32_t x; int32_t y; };
+  LOG_ASSERT(Hash<Team>{}(Team::Red) != Hash<Team>{}(Team::Blue), failedMsg);
+  LOG_ASSERT(Hash<GenId>{}(GenId::create(1, 0)) != Hash<GenId>{}(GenId::create(1, 1)), failedMsg);
+  LOG_ASSERT(Hash<Cell>{}(Cell{1, 2}) == Hash<Cell>{}(Cell{1, 2}), failedMsg);
+  LOG_ASSERT(Hash<Cell>{}(Cell{1, 2}) != Hash<Cell>{}(Cell{2, 1}), failedMsg);
+  LOG_ASSERT(Hash<uint64_t>{}(1ULL << 40) != Hash<uint64_t>{}(1ULL << 41), failedMsg);
+
+  // Combining is order dependent
+  uint64_t a = hash_u64(1);
+  uint64_t b = hash_u64(2);
+  LOG_ASSERT(hash_combine(a, b) != hash_combine(b, a), failedMsg);
+
+  LOG_TRACE("[ PASSED ] hashing_test")
+}
+
+void key_compare_test() {
+  const char* failedMsg = "[ FAILED ] key_compare_test";
+
+  // 8 byte keys used to go through strcmp & stop at the first zero byte
+  LOG_ASSERT(!KeyCompare<uint64_t>::equals(1ULL, 1ULL | (1ULL << 40)), failedMsg);
+  LOG_ASSERT(!KeyCompare<double>::equals(1.0, 1.5), failedMsg);
+  LOG_ASSERT(KeyCompare<double>::equals(2.5, 2.5), failedMsg);
+  LOG_ASSERT(!KeyCompare<uint32_t>::equals(0x0100, 0x0200), failedMsg);
+
+  // C strings compare by content, fixed arrays stop at their size
+  char a[] = "rover";
+  char b[] = "rover";
+  LOG_ASSERT(KeyCompare<const char*>::equals(a, b), failedMsg);
+  LOG_ASSERT(!KeyCompare<const char*>::equals(a, nullptr), failedMsg);
+  char fixedA[4] = {'a', 'b', 'c', 'd'};
+  char fixedB[4] = {'a', 'b', 'c', 'e'};
+  LOG_ASSERT(!KeyCompare<char[4]>::equals(fixedA, fixedB), failedMsg);
+
+  // Types with operator== use it, padding free PODs compare their bytes
+  struct Cell { int32_t x; int32_t y; };
+  LOG_ASSERT(KeyCompare<Cell>::equals(Cell{1, 2}, Cell{1, 2}), failedMsg);
+  LOG_ASSERT(!KeyCompare<Cell>::equals(Cell{1, 2}, Cell{1, 3}), failedMsg);
+  LOG_ASSERT(KeyCompare<GenId>::equals(GenId::create(3, 1), GenId::create(3, 1)), failedMsg);
+  LOG_ASSERT(!KeyCompare<GenId>::equals(GenId::create(3, 1), GenId::create(3, 2)), failedMsg);
+
+  // Integer keyed maps
+  MapCT<uint64_t, int, 4> map = {};
+  map[1ULL] = 1;
+  map[1ULL | (1ULL << 40)] = 2;
+  LOG_ASSERT(map.size() == 2 && map[1ULL] == 1 && map[1ULL | (1ULL << 40)] == 2, failedMsg);
+
+  Arena& arena = *new Arena(KB(4));
+  auto& hashmap = arena.create_hashmap_ct<uint64_t, int, 16>();
+  for (uint64_t i = 0; i < 10; i++) hashmap[i << 32] = (int)i;
+  for (uint64_t i = 0; i < 10; i++) LOG_ASSERT(hashmap[i << 32] == (int)i, failedMsg);
+  LOG_ASSERT(hashmap.size() == 10, failedMsg);
+
+  delete &arena;
+  LOG_TRACE("[ PASSED ] key_compare_test")
+}
+
 void quicksort_test() {
   const char* failedMsg = "[ FAILED ] quicksort_test";
   
@@ -317,6 +538,876 @@ void quicksort_test() {
   LOG_TRACE("[ PASSED ] quicksort_test");
 }
 
+void sort_test() {
+  const char* failedMsg = "[ FAILED ] sort_test";
+  Arena& arena = *new Arena(MB(1));
+  const uint32_t n = 20000;
+  ArrayRT<uint32_t>& arr = arena.create_array_rt<uint32_t>(n);
+
+  // Patterns that degrade a naive quicksort
+  for (int pattern = 0; pattern < 5; pattern++) {
+    arr.clear();
+    uint64_t state = 0x2545F4914F6CDD1DULL;
+    for (uint32_t i = 0; i < n; i++) {
+      uint32_t value = 0;
+      switch (pattern) {
+        case 0: value = i; break;                             // Sorted
+        case 1: value = n - i; break;                         // Reversed
+        case 2: value = 7; break;                             // All equal
+        case 3: value = i < n / 2 ? i : n - i; break;         // Organ pipe
+        case 4: state = hash_u64(state); value = (uint32_t)(state % 1000); break; // Random, many duplicates
+      }
+      arr.add(value);
+    }
+    sort(arr);
+    bool sorted = true;
+    for (uint32_t i = 1; i < n; i++) sorted &= arr[i - 1] <= arr[i];
+    LOG_ASSERT(sorted, failedMsg);
+  }
+
+  // Comparator & key projection
+  {
+    ArrayCT<int, 6> desc = {};
+    int numbers[] = {3, -1, 4, 1, -5, 9};
+    desc.add(numbers, 6);
+    sort(desc, [](int a, int b) { return a > b; });
+    LOG_ASSERT(desc[0] == 9 && desc[1] == 4 && desc[5] == -5, failedMsg);
+
+    ArrayCT<Entity, 4> entities = {};
+    entities.add(Entity{3, "c"});
+    entities.add(Entity{1, "a"});
+    entities.add(Entity{4, "d"});
+    entities.add(Entity{2, "b"});
+    sort(entities, SortLess{}, [](const Entity& e) { return -e.id; });
+    LOG_ASSERT(entities[0].id == 4 && entities[1].id == 3 && entities[2].id == 2 && entities[3].id == 1, failedMsg);
+  }
+
+  // Stable sort keeps the insertion order of equal keys & returns its scratch memory
+  {
+    ArrayRT<Entity>& entities = arena.create_array_rt<Entity>(1000);
+    for (int i = 0; i < 1000; i++) entities.add(Entity{(int)(hash_u64(i) % 10), (char*)(uintptr_t)i});
+    uint64_t used = arena.used;
+    stable_sort(entities, arena);
+    LOG_ASSERT(arena.used == used, failedMsg);
+    bool stable = true;
+    for (uint32_t i = 1; i < entities.count; i++) {
+      if (entities[i - 1].id > entities[i].id) stable = false;
+      if (entities[i - 1].id == entities[i].id && entities[i - 1].name > entities[i].name) stable = false;
+    }
+    LOG_ASSERT(stable, failedMsg);
+  }
+
+  // Non trivial elements are only ever assigned to constructed buffer slots
+  {
+    struct Tracked {
+      uint32_t state = 0xA11FE; // Alive
+      int key = 0;
+      Tracked() = default;
+      Tracked(const Tracked& other) = default;
+      Tracked& operator=(const Tracked& other) {
+        key = state == 0xA11FE ? other.key : INT32_MIN; // Poisons the sort if assigned into raw memory
+        return *this;
+      }
+      ~Tracked() { state = 0; }
+    };
+    Tracked tracked[100];
+    for (int i = 0; i < 100; i++) tracked[i].key = (int)(hash_u64(i) % 50);
+    {
+      ArenaTemp temp(arena);
+      memset(arena.alloc_raw<char>(KB(4)), 0xCD, KB(4)); // Stale bytes where the merge buffer goes
+    }
+    stable_sort(tracked, tracked + 100, arena, SortLess{}, [](const Tracked& t) { return t.key; });
+    bool sorted = tracked[0].key >= 0;
+    for (uint32_t i = 1; i < 100; i++) sorted = sorted && tracked[i - 1].key <= tracked[i].key;
+    LOG_ASSERT(sorted, failedMsg);
+  }
+
+  delete &arena;
+  LOG_TRACE("[ PASSED ] sort_test");
+}
+
+void radix_sort_test() {
+  const char* failedMsg = "[ FAILED ] radix_sort_test";
+  Arena& arena = *new Arena(MB(4));
+
+  // Signed & float keys keep their natural order
+  {
+    ArrayCT<int, 6> ints = {};
+    int numbers[] = {3, -1, 400000, 0, -70000, 9};
+    ints.add(numbers, 6);
+    radix_sort(ints, arena);
+    LOG_ASSERT(ints[0] == -70000 && ints[1] == -1 && ints[2] == 0 && ints[5] == 400000, failedMsg);
+
+    ArrayCT<float, 6> floats = {};
+    float values[] = {1.5f, -0.25f, -100.0f, 0.0f, 3e8f, -3e-8f};
+    floats.add(values, 6);
+    radix_sort(floats, arena);
+    LOG_ASSERT(floats[0] == -100.0f && floats[1] == -0.25f && floats[2] == -3e-8f &&
+               floats[3] == 0.0f && floats[4] == 1.5f && floats[5] == 3e8f, failedMsg);
+  }
+
+  // Packed draw keys through a projection, equal keys keep their order
+  {
+    struct DrawCall { uint64_t key; uint32_t order; };
+    const uint32_t n = 5000;
+    ArrayRT<DrawCall>& draws = arena.create_array_rt<DrawCall>(n);
+    for (uint32_t i = 0; i < n; i++) {
+      uint64_t h = hash_u64(i);
+      draws.add(DrawCall{pack_sort_key((uint16_t)(h % 4), (uint16_t)(h >> 16) % 8, (float)(h >> 32 & 3) - 1.5f), i});
+    }
+    uint64_t used = arena.used;
+    radix_sort(draws, arena, [](const DrawCall& d) { return d.key; });
+    LOG_ASSERT(arena.used == used, failedMsg);
+    bool sorted = true;
+    for (uint32_t i = 1; i < n; i++) {
+      if (draws[i - 1].key > draws[i].key) sorted = false;
+      if (draws[i - 1].key == draws[i].key && draws[i - 1].order > draws[i].order) sorted = false;
+    }
+    LOG_ASSERT(sorted, failedMsg);
+    LOG_ASSERT(pack_sort_key(0, 1, 100.0f) < pack_sort_key(1, 0, -5.0f), failedMsg);
+    LOG_ASSERT(pack_sort_key(2, 3, -5.0f) < pack_sort_key(2, 3, 1.0f), failedMsg);
+  }
+
+  // Parallel sort with an uneven number of runs
+  {
+    const uint32_t n = 200000;
+    ArrayRT<uint32_t>& keys = arena.create_array_rt<uint32_t>(n);
+    for (uint32_t i = 0; i < n; i++) keys.add((uint32_t)hash_u64(i));
+    uint64_t used = arena.used;
+    parallel_sort(keys, arena, SortLess{}, SortIdentity{}, 5);
+    LOG_ASSERT(arena.used == used, failedMsg);
+    bool sorted = true;
+    for (uint32_t i = 1; i < n; i++) sorted &= keys[i - 1] <= keys[i];
+    LOG_ASSERT(sorted, failedMsg);
+  }
+
+  delete &arena;
+  LOG_TRACE("[ PASSED ] radix_sort_test");
+}
+
+void soa_test() {
+  const char* failedMsg = "[ FAILED ] soa_test";
+  Arena& arena = *new Arena(KB(16));
+  struct Position { float x, y; };
+  SoART<Position, float, bool>& units = arena.create_soa_rt<Position, float, bool>(100);
+
+  for (uint32_t i = 0; i < 100; i++) units.add(Position{(float)i, 0.0f}, 1.0f, i % 2 == 0);
+  LOG_ASSERT(units.is_full() && units.size() == 100, failedMsg);
+  LOG_ASSERT((uintptr_t)units.column_data<0>() % 64 == 0 && (uintptr_t)units.column_data<1>() % 64 == 0 &&
+             (uintptr_t)units.column_data<2>() % 64 == 0, failedMsg);
+
+  // Column sweep
+  Span<float> speeds = units.column<1>();
+  for (float& speed : speeds) speed *= 2.0f;
+  float total = 0.0f;
+  for (uint32_t i = 0; i < speeds.size(); i++) total += speeds[i];
+  LOG_ASSERT(total == 200.0f, failedMsg);
+
+  // Row proxy writes through to the columns
+  auto [position, speed, active] = units[10];
+  position.y = 5.0f;
+  speed = 3.0f;
+  LOG_ASSERT(units.get<0>(10).y == 5.0f && units.get<1>(10) == 3.0f && active, failedMsg);
+
+  // Swap remove moves the last row into the hole in every column
+  units.remove(10);
+  LOG_ASSERT(units.size() == 99, failedMsg);
+  LOG_ASSERT(units.get<0>(10).x == 99.0f && units.get<1>(10) == 2.0f && !units.get<2>(10), failedMsg);
+  units.remove(98);
+  LOG_ASSERT(units.size() == 98 && units.get<0>(97).x == 97.0f, failedMsg);
+
+  units.clear();
+  LOG_ASSERT(units.empty() && units.column<0>().size() == 0, failedMsg);
+
+  delete &arena;
+  LOG_TRACE("[ PASSED ] soa_test");
+}
+
+void paged_gen_sparse_set_test() {
+  const char* failedMsg = "[ FAILED ] paged_gen_sparse_set_test";
+  Arena& arena = *new Arena(KB(256));
+  static_assert(sizeof(GenHandle<20, 12>) == 4 && sizeof(GenHandle<32, 32>) == 8, "Handle storage follows its bits");
+
+  {
+    using Handle = GenHandle<20, 12>;
+    auto& set = arena.create_paged_gen_sparse_set_rt<int, Handle, 64>(10000);
+    Handle a = set.add(1);
+    Handle b = set.add(2);
+    Handle c = set.add(3);
+    LOG_ASSERT(set.size() == 3 && *set[a] == 1 && *set[b] == 2 && *set[c] == 3, failedMsg);
+    LOG_ASSERT(set.pages[0] != nullptr && set.pages[1] == nullptr, failedMsg); // Only the touched page exists
+
+    set.remove(a);
+    LOG_ASSERT(!set.contains(a) && set.get(a) == nullptr && *set[c] == 3, failedMsg);
+    Handle reused = set.add(4);
+    LOG_ASSERT(reused.id() == a.id() && reused.gen() == a.gen() + 1 && !set.contains(a), failedMsg);
+    LOG_ASSERT(set.find(4) == reused && set.find(99) == Handle::null(), failedMsg);
+
+    // Lazy clear, handles from before the clear stay dead once their slots are reused
+    set.clear();
+    LOG_ASSERT(set.empty() && !set.contains(b) && !set.contains(c), failedMsg);
+    Handle d = set.add(5);
+    LOG_ASSERT(d.id() == reused.id() && d != reused && !set.contains(reused) && *set[d] == 5, failedMsg);
+  }
+
+  // Slots retire instead of wrapping their generation
+  {
+    using Handle = GenHandle<8, 2>;
+    auto& set = arena.create_paged_gen_sparse_set_rt<int, Handle, 16>(16);
+    Handle first = set.add(0);
+    Handle last = first;
+    for (int i = 0; i < 3; i++) {
+      set.remove(last);
+      last = set.add(i);
+      LOG_ASSERT(last.id() == first.id(), failedMsg);
+    }
+    LOG_ASSERT(last.gen() == Handle::MAX_GEN, failedMsg);
+    set.remove(last);
+    Handle next = set.add(7);
+    LOG_ASSERT(next.id() != first.id() && !set.contains(first) && !set.contains(last), failedMsg);
+  }
+
+  delete &arena;
+  LOG_TRACE("[ PASSED ] paged_gen_sparse_set_test");
+}
+
+void component_view_test() {
+  const char* failedMsg = "[ FAILED ] component_view_test";
+  Arena& arena = *new Arena(KB(64));
+  struct Velocity { float x, y; };
+  auto& entities = arena.create_gen_sparse_set_rt<int>(64);
+  auto& positions = arena.create_component_set_rt<float>(64);
+  auto& velocities = arena.create_component_set_rt<Velocity>(64);
+  auto& programs = arena.create_component_set_rt<int>(64);
+
+  GenId ids[32];
+  for (int i = 0; i < 32; i++) {
+    ids[i] = entities.add(i);
+    positions.set(ids[i], (float)i);
+    if (i % 2 == 0) velocities.set(ids[i], Velocity{1.0f, 0.0f});
+    if (i % 4 == 0) programs.set(ids[i], i);
+  }
+
+  // View walks the smallest set & skips entities missing a component
+  {
+    View<float, Velocity, int> view(positions, velocities, programs);
+    uint32_t visited = 0;
+    view.each([&](GenId entity, float& position, Velocity& velocity, int& program) {
+      position += velocity.x;
+      LOG_ASSERT(program % 4 == 0 && *entities[entity] == program, failedMsg);
+      visited++;
+    });
+    LOG_ASSERT(visited == 8 && view.size_hint() == 8 && *positions[ids[4]] == 5.0f && *positions[ids[2]] == 2.0f, failedMsg);
+  }
+
+  // Owning group keeps the joined components packed & aligned at the front
+  {
+    Group<float, Velocity>& group = arena.create_group(positions, velocities);
+    LOG_ASSERT(group.size() == 16, failedMsg);
+
+    auto check_aligned = [&]() {
+      Span<GenId> grouped = group.entities();
+      Span<float> groupPositions = group.column<0>();
+      for (uint32_t i = 0; i < grouped.size(); i++) {
+        LOG_ASSERT(velocities.dense_ids->get(i) == grouped[i] && positions[grouped[i]] == &groupPositions[i], failedMsg);
+      }
+    };
+    check_aligned();
+
+    velocities.set(ids[1], Velocity{2.0f, 0.0f}); // Joins the group
+    velocities.remove(ids[0]); // Leaves the group
+    positions.remove(ids[2]); // Leaves the group
+    LOG_ASSERT(group.size() == 15 && group.owns(ids[1]) && !group.owns(ids[0]) && !group.owns(ids[2]), failedMsg);
+    check_aligned();
+
+    float sum = 0.0f;
+    group.each([&](GenId entity, float& position, Velocity& velocity) { sum += velocity.x; });
+    LOG_ASSERT(sum == 16.0f, failedMsg);
+
+    GenId late = entities.add(99);
+    velocities.set(late, Velocity{});
+    LOG_ASSERT(!group.owns(late), failedMsg);
+    positions.set(late, 0.0f);
+    LOG_ASSERT(group.owns(late) && group.size() == 16, failedMsg);
+    check_aligned();
+
+    // A recycled id replaces the components its previous generation left behind
+    uint32_t positionCount = positions.size();
+    entities.remove(ids[4]);
+    GenId recycled = entities.add(4);
+    LOG_ASSERT(recycled.id() == ids[4].id() && recycled != ids[4], failedMsg);
+    positions.set(recycled, 40.0f);
+    velocities.set(recycled, Velocity{3.0f, 0.0f});
+    LOG_ASSERT(positions.size() == positionCount && !positions.contains(ids[4]) && *positions[recycled] == 40.0f, failedMsg);
+    LOG_ASSERT(group.size() == 16 && group.owns(recycled) && !group.owns(ids[4]), failedMsg);
+    check_aligned();
+
+    uint32_t visited = 0;
+    View<float, Velocity>(positions, velocities).each([&](GenId entity, float& position, Velocity& velocity) {
+      LOG_ASSERT(entity != ids[4], failedMsg);
+      visited++;
+    });
+    LOG_ASSERT(visited == 16, failedMsg);
+
+    positions.remove(recycled);
+    LOG_ASSERT(positions.size() == positionCount - 1 && group.size() == 15 && positions.index_of(recycled) == ComponentSetRT<float>::NONE, failedMsg);
+    check_aligned();
+
+    // Simulated reload: the hooks are dropped with the old code, stale ones must never run
+    group.detach();
+    LOG_ASSERT(!positions.on_add && !positions.on_remove && !velocities.on_add && !velocities.on_remove, failedMsg);
+    static bool staleCalled = false;
+    positions.on_add = velocities.on_add = [](void* owner, GenId entity) { staleCalled = true; };
+    positions.on_remove = velocities.on_remove = [](void* owner, GenId entity) { staleCalled = true; };
+    group.attach();
+    positions.set(recycled, 41.0f); // Joins the group
+    velocities.remove(ids[6]); // Leaves the group
+    LOG_ASSERT(!staleCalled && group.size() == 15 && group.owns(recycled) && !group.owns(ids[6]), failedMsg);
+    check_aligned();
+  }
+
+  delete &arena;
+  LOG_TRACE("[ PASSED ] component_view_test");
+}
+
+void arena_virtual_memory_test() {
+  const char* failedMsg = "[ FAILED ] arena_virtual_memory_test";
+  Arena& arena = *new Arena(GB(8)); // Reserved only, nothing is backed yet
+  LOG_ASSERT(arena.capacity == GB(8) && arena.committed == 0, failedMsg);
+
+  uint64_t* first = arena.alloc_count_raw<uint64_t>(4);
+  LOG_ASSERT(arena.committed == Arena::commitGranularity && first[0] == 0 && first[3] == 0, failedMsg);
+  first[0] = 42;
+
+  char* big = arena.alloc_raw<char>(Arena::commitGranularity * 2);
+  LOG_ASSERT(arena.committed == Arena::commitGranularity * 3, failedMsg);
+  big[Arena::commitGranularity * 2 - 1] = 1;
+
+  arena.clear();
+  LOG_ASSERT(arena.used == 0 && arena.committed == Arena::commitGranularity * 3, failedMsg);
+  LOG_ASSERT(arena.alloc<uint64_t>() == 0, failedMsg);
+
+  arena.alloc<uint64_t>() = 7;
+  arena.clear(ArenaClear::Decommit);
+  LOG_ASSERT(arena.used == 0 && arena.committed == 0, failedMsg);
+  uint64_t* reused = arena.alloc_count_raw<uint64_t>(2);
+  LOG_ASSERT(reused[0] == 0 && reused[1] == 0, failedMsg);
+
+  delete &arena;
+  LOG_TRACE("[ PASSED ] arena_virtual_memory_test");
+}
+
+void arena_temp_test() {
+  const char* failedMsg = "[ FAILED ] arena_temp_test";
+  Arena& arena = *new Arena(KB(64));
+  int& persistent = arena.alloc<int>();
+  persistent = 1;
+  uint64_t base = arena.used;
+  {
+    ArenaTemp outer(arena);
+    arena.alloc_count_raw<int>(100);
+    uint64_t afterOuter = arena.used;
+    {
+      ArenaTemp inner(arena);
+      arena.alloc_count_raw<int>(1000);
+    }
+    LOG_ASSERT(arena.used == afterOuter, failedMsg);
+  }
+  LOG_ASSERT(arena.used == base && persistent == 1, failedMsg);
+
+  uint64_t mark = arena.save();
+  int* scratch = arena.alloc_count_raw<int>(10);
+  scratch[9] = 5;
+  arena.restore(mark);
+  LOG_ASSERT(arena.used == base && arena.highWater == base + 400 + 4000, failedMsg); // Peak of the nested scopes
+
+  // Opting out of zeroing leaves the old bytes, a zeroing clear later still catches them
+  arena.clear(ArenaClear::NoZero);
+  LOG_ASSERT(arena.used == 0 && arena.alloc<int>() == 1, failedMsg);
+  arena.clear();
+  LOG_ASSERT(arena.highWater == 0, failedMsg);
+  int* zeroed = arena.alloc_count_raw<int>(12);
+  LOG_ASSERT(zeroed[0] == 0 && zeroed[11] == 0, failedMsg);
+
+  delete &arena;
+  LOG_TRACE("[ PASSED ] arena_temp_test");
+}
+
+void arena_alignment_test() {
+  const char* failedMsg = "[ FAILED ] arena_alignment_test";
+  Arena& arena = *new Arena(KB(64));
+  struct alignas(32) Vec8 { float lanes[8]; };
+
+  arena.alloc<char>();
+  Vec8* vectors = arena.alloc_count_raw<Vec8>(3);
+  LOG_ASSERT((uintptr_t)vectors % 32 == 0, failedMsg);
+
+  arena.alloc<char>();
+  void* block = arena.alloc_aligned(10, 64);
+  LOG_ASSERT((uintptr_t)block % 64 == 0, failedMsg);
+
+  CacheLinePadded<uint64_t>* counters = arena.alloc_padded<uint64_t>(4);
+  LOG_ASSERT((uintptr_t)&counters[0].value % CACHE_LINE_SIZE == 0, failedMsg);
+  LOG_ASSERT((uintptr_t)&counters[1].value - (uintptr_t)&counters[0].value == CACHE_LINE_SIZE, failedMsg);
+
+  arena.alloc<char>();
+  ArrayRT<float>& floats = arena.create_array_rt<float>(16);
+  LOG_ASSERT((uintptr_t)floats.elements % CACHE_LINE_SIZE == 0 && floats.capacity() == 16, failedMsg);
+
+  delete &arena;
+  LOG_TRACE("[ PASSED ] arena_alignment_test");
+}
+
+void pool_test() {
+  const char* failedMsg = "[ FAILED ] pool_test";
+  Arena& arena = *new Arena(MB(1));
+  struct Projectile { float x, y; int owner; };
+
+  {
+    Pool<Projectile>& pool = arena.create_pool<Projectile>(64, 16);
+    Projectile* a = pool.alloc(Projectile{1.0f, 2.0f, 3});
+    Projectile* b = pool.alloc();
+    LOG_ASSERT(a->owner == 3 && pool.size() == 2 && pool.stats().capacity == 16, failedMsg);
+
+    pool.free(a);
+    Projectile* c = pool.alloc();
+    LOG_ASSERT(c == a && pool.size() == 2, failedMsg); // Freed slot is reused first
+
+    GenId handle = pool.handle_of(c);
+    LOG_ASSERT(pool[handle] == c && handle.gen() == 1, failedMsg);
+    pool.free(handle);
+    LOG_ASSERT(pool.get(handle) == nullptr, failedMsg);
+    pool.free(handle); // Stale handles are ignored
+
+    // Growing keeps pointers stable
+    GenId handles[40];
+    for (int i = 0; i < 40; i++) handles[i] = pool.alloc_handle(Projectile{0.0f, 0.0f, i});
+    LOG_ASSERT(b == pool.get(pool.handle_of(b)) && pool[handles[39]]->owner == 39, failedMsg);
+    PoolStats stats = pool.stats();
+    LOG_ASSERT(stats.live == 41 && stats.peak == 41 && stats.capacity == 48 && stats.maxElements == 64, failedMsg);
+    for (int i = 0; i < 40; i++) pool.free(handles[i]);
+    LOG_ASSERT(pool.size() == 1 && pool.stats().peak == 41, failedMsg);
+  }
+
+  {
+    SlabAllocator& slab = arena.create_slab_allocator();
+    LOG_ASSERT(SlabAllocator::size_class(1) == 0 && SlabAllocator::size_class(17) == 1 &&
+               SlabAllocator::size_class(2048) == SlabAllocator::classCount - 1, failedMsg);
+    void* small = slab.alloc(24);
+    void* other = slab.alloc(32);
+    LOG_ASSERT((uintptr_t)small % 16 == 0 && (char*)other - (char*)small == 32, failedMsg);
+    slab.free(small, 24);
+    LOG_ASSERT(slab.alloc(20) == small, failedMsg);
+
+    Projectile* projectile = slab.create<Projectile>(Projectile{1.0f, 1.0f, 7});
+    LOG_ASSERT(projectile->owner == 7 && slab.classStats[0].live == 1 && slab.classStats[1].live == 2, failedMsg);
+    slab.destroy(projectile);
+    LOG_ASSERT(slab.classStats[0].live == 0 && slab.classStats[0].peak == 1 && slab.classStats[1].slabs == 1, failedMsg);
+  }
+
+  delete &arena;
+  LOG_TRACE("[ PASSED ] pool_test");
+}
+
+void arena_stats_test() {
+  const char* failedMsg = "[ FAILED ] arena_stats_test";
+  Arena& arena = *new Arena(KB(64));
+  ArenaStats stats;
+  arena.instrument(stats, "test", 0.5f);
+
+  arena.alloc<uint64_t>();
+  {
+    ArenaTagScope models(arena, "models");
+    arena.alloc_count_raw<char>(1000);
+    {
+      ArenaTagScope gui(arena, "gui");
+      arena.alloc_count_raw<char>(16);
+    }
+    arena.alloc_count_raw<char>(24);
+  }
+  LOG_ASSERT(stats.allocations == 4 && stats.tagCount == 3 && stats.currentTag[0] == 0, failedMsg);
+  LOG_ASSERT(strcmp(stats.tags[0].tag, "untagged") == 0 && stats.tags[0].bytes == 8, failedMsg);
+  LOG_ASSERT(strcmp(stats.tags[1].tag, "models") == 0 && stats.tags[1].bytes == 1024 && stats.tags[1].allocations == 2, failedMsg);
+  LOG_ASSERT(strcmp(stats.tags[2].tag, "gui") == 0 && stats.tags[2].bytes == 16, failedMsg);
+
+  // Tags are copied, the caller's string may go away with a reloaded library
+  {
+    char transient[16] = "reloaded";
+    ArenaTagScope reloaded(arena, transient);
+    arena.alloc<uint64_t>();
+    strcpy(transient, "garbage");
+    arena.alloc<uint64_t>();
+  }
+  LOG_ASSERT(stats.tagCount == 4 && strcmp(stats.tags[3].tag, "reloaded") == 0 && stats.tags[3].allocations == 2, failedMsg);
+  LOG_ASSERT(!stats.overBudget, failedMsg);
+
+  arena.alloc_count_raw<char>(KB(40)); // Past half the capacity
+  LOG_ASSERT(stats.overBudget && stats.peakUsed == arena.used, failedMsg);
+
+  uint64_t peak = stats.peakUsed;
+  arena.clear();
+  LOG_ASSERT(stats.clears == 1 && stats.lastClearTime != 0 && !stats.overBudget && stats.tagCount == 0, failedMsg);
+  arena.alloc<uint64_t>();
+  LOG_ASSERT(stats.peakUsed == peak, failedMsg); // Peak survives clears
+
+  const char* filePath = "./arena_stats_test";
+  const Arena* arenas[] = {&arena};
+  LOG_ASSERT(write_arena_stats(filePath, arenas, 1), failedMsg);
+  char* report = read_file(filePath, arena);
+  LOG_ASSERT(report && strstr(report, "Arena test:") && strstr(report, "untagged"), failedMsg);
+  remove_file(filePath);
+
+  delete &arena;
+  LOG_TRACE("[ PASSED ] arena_stats_test");
+}
+
+void ring_buffer_test() {
+  const char* failedMsg = "[ FAILED ] ring_buffer_test";
+  Arena& arena = *new Arena(MB(1));
+
+  {
+    SPSCQueueRT<int>& queue = arena.create_spsc_queue_rt<int>(6);
+    LOG_ASSERT(queue.capacity() == 8 && queue.empty(), failedMsg);
+    int values[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+    LOG_ASSERT(queue.try_push(values, 10) == 8 && !queue.try_push(11), failedMsg);
+    int out[4];
+    LOG_ASSERT(queue.try_pop(out, 4) == 4 && out[0] == 1 && out[3] == 4 && queue.size() == 4, failedMsg);
+    LOG_ASSERT(queue.try_push(values + 8, 2) == 2 && queue.size() == 6, failedMsg); // Wraps around
+    int value = 0;
+    for (int expected = 5; expected <= 10; expected++) LOG_ASSERT(queue.try_pop(value) && value == expected, failedMsg);
+    LOG_ASSERT(!queue.try_pop(value), failedMsg);
+  }
+
+  {
+    SPSCQueueRT<uint32_t>& queue = arena.create_spsc_queue_rt<uint32_t>(64);
+    const uint32_t n = 100000;
+    std::thread producer([&]() { for (uint32_t i = 0; i < n; i++) queue.push(i); });
+    bool ordered = true;
+    for (uint32_t i = 0; i < n; i++) ordered &= queue.pop() == i;
+    producer.join();
+    LOG_ASSERT(ordered && queue.empty(), failedMsg);
+  }
+
+  {
+    MPMCQueueRT<uint64_t>& queue = arena.create_mpmc_queue_rt<uint64_t>(128);
+    const uint32_t threads = 4;
+    const uint64_t perThread = 20000;
+    std::atomic<uint64_t> sum{0};
+    std::thread producers[threads];
+    std::thread consumers[threads];
+    for (uint32_t t = 0; t < threads; t++) {
+      producers[t] = std::thread([&, t]() { for (uint64_t i = 1; i <= perThread; i++) queue.push(t * perThread + i); });
+      consumers[t] = std::thread([&]() {
+        uint64_t local = 0;
+        for (uint64_t i = 0; i < perThread; i++) local += queue.pop();
+        sum += local;
+      });
+    }
+    for (uint32_t t = 0; t < threads; t++) {
+      producers[t].join();
+      consumers[t].join();
+    }
+    uint64_t total = threads * perThread;
+    LOG_ASSERT(sum == total * (total + 1) / 2 && queue.empty(), failedMsg);
+
+    uint64_t batch[200];
+    for (uint64_t i = 0; i < 200; i++) batch[i] = i;
+    LOG_ASSERT(queue.try_push(batch, 200) == 128 && queue.try_pop(batch, 200) == 128 && batch[127] == 127, failedMsg);
+  }
+
+  delete &arena;
+  LOG_TRACE("[ PASSED ] ring_buffer_test");
+}
+
+void bitset_test() {
+  const char* failedMsg = "[ FAILED ] bitset_test";
+  Arena& arena = *new Arena(KB(64));
+
+  {
+    BitsetCT<100>& bits = arena.create_bitset_ct<100>();
+    bits.set(3);
+    bits.set(64);
+    bits.set(99);
+    LOG_ASSERT(bits.test(3) && bits[64] && !bits[4] && bits.count() == 3, failedMsg);
+    bits.reset(64);
+    bits.flip(5);
+    LOG_ASSERT(!bits[64] && bits[5] && bits.count() == 3, failedMsg);
+
+    uint32_t expected[] = {3, 5, 99};
+    uint32_t visited = 0;
+    for (uint32_t idx : bits) LOG_ASSERT(idx == expected[visited++], failedMsg);
+    LOG_ASSERT(visited == 3 && bits.find_first() == 3 && bits.find_next(5) == 99 && bits.find_next(99) == UINT32_MAX, failedMsg);
+
+    bits.clear();
+    LOG_ASSERT(bits.none() && bits.find_first() == UINT32_MAX, failedMsg);
+    bits.set_range(10, 70);
+    LOG_ASSERT(bits.count() == 60 && !bits[9] && bits[10] && bits[69] && !bits[70], failedMsg);
+    bits.reset_range(20, 21);
+    LOG_ASSERT(bits.count() == 59 && !bits[20], failedMsg);
+    bits.set_all();
+    LOG_ASSERT(bits.count() == 100, failedMsg); // Padding bits stay clear
+  }
+
+  // Bulk ops across enough words to take the AVX2 path
+  {
+    const uint32_t n = 1000;
+    BitsetRT& a = arena.create_bitset_rt(n);
+    BitsetRT& b = arena.create_bitset_rt(n);
+    BitsetCT<n>& c = arena.create_bitset_ct<n>();
+    for (uint32_t i = 0; i < n; i += 2) a.set(i);
+    for (uint32_t i = 0; i < n; i += 3) b.set(i);
+    c.set_range(0, n);
+
+    BitsetRT& both = arena.create_bitset_rt(n);
+    both.or_with(a);
+    both.and_with(b);
+    LOG_ASSERT(both.count() == 167, failedMsg); // Multiples of 6 below 1000
+
+    both.or_with(a);
+    both.or_with(b);
+    LOG_ASSERT(both.count() == 500 + 334 - 167, failedMsg);
+
+    c.and_not_with(both);
+    LOG_ASSERT(c.count() == n - 667 && !c[0] && c[1] && !c[2] && !c[3], failedMsg);
+    c.xor_with(c);
+    LOG_ASSERT(c.none(), failedMsg);
+  }
+
+  delete &arena;
+  LOG_TRACE("[ PASSED ] bitset_test");
+}
+
+struct LogCapture {
+  char text[16384];
+  uint32_t length;
+};
+
+static void log_capture_sink(const char* line, LogLevel level, void* user) {
+  LogCapture* capture = (LogCapture*)user;
+  int written = snprintf(capture->text + capture->length, sizeof(capture->text) - capture->length, "%s\n", line);
+  if (written > 0) capture->length = std::min<uint32_t>(capture->length + written, sizeof(capture->text) - 1);
+}
+
+void log_test() {
+  const char* failedMsg = "[ FAILED ] log_test";
+  static LogCapture capture = {};
+  log_set_sink(log_capture_sink, &capture);
+  log_start();
+
+  // Strings are copied at the call site, the buffer can be reused right away
+  char name[16] = "alpha";
+  LOG_TRACE("log %s %d %.1f", name, 7, 2.5);
+  strcpy(name, "omega");
+  log_flush();
+  bool copied = strstr(capture.text, "TRACE:  log alpha 7 2.5") != nullptr;
+  bool overwritten = strstr(capture.text, "omega") != nullptr;
+
+  LogChannel channel("net", LogLevel::Warn);
+  LOG_TRACE_TO(channel, "hidden trace");
+  LOG_WARN_TO(channel, "shown warn %u", 3u);
+  channel.set_level(LogLevel::Error);
+  LOG_WARN_TO(channel, "hidden warn");
+  LOG_ERROR_TO(channel, "shown error %s", (const char*)nullptr);
+
+  std::thread worker([]() {
+    for (uint32_t i = 0; i < 100; i++) {
+      LOG_TRACE("worker %u", i);
+    }
+  });
+  worker.join();
+  log_stop();
+
+  log_set_sink(nullptr, nullptr);
+  LOG_ASSERT(copied, failedMsg);
+  LOG_ASSERT(!overwritten, failedMsg);
+  LOG_ASSERT(strstr(capture.text, "WARN: [net] shown warn 3"), failedMsg);
+  LOG_ASSERT(strstr(capture.text, "ERROR: [net] shown error (null)"), failedMsg);
+  LOG_ASSERT(!strstr(capture.text, "hidden"), failedMsg);
+  LOG_ASSERT(strstr(capture.text, "worker 0 ") && strstr(capture.text, "worker 99 "), failedMsg);
+  LOG_ASSERT(strstr(capture.text, "worker 42 ") > strstr(capture.text, "worker 41 "), failedMsg);
+
+  LOG_TRACE("[ PASSED ] log_test");
+}
+
+static void trace_read_back(bool (*decode)(const char*, FILE*), const char* path, char* text, uint32_t size) {
+  FILE* out = tmpfile();
+  decode(path, out);
+  rewind(out);
+  uint32_t length = (uint32_t)fread(text, 1, size - 1, out);
+  text[length] = 0;
+  fclose(out);
+}
+
+void trace_test() {
+  const char* failedMsg = "[ FAILED ] trace_test";
+  const char* path = "trace_test.trace";
+  enum class Mode : uint8_t { Idle, Scan = 3 };
+
+  TraceBuffer* buffer = trace_open(path, 60); // Rounds up to 64 records
+  LOG_ASSERT(buffer && buffer->mask == 63, failedMsg);
+
+  char name[8] = "rover";
+  TRACE("entity %u %s mode %d speed %.2f", 7u, name, Mode::Scan, 1.5f);
+  strcpy(name, "wheel");
+  TRACE("big %lld %llu %x", -5ll, 1ull << 40, 255);
+  TRACE("%s", "a string far longer than one record can hold, it gets truncated to the payload");
+  std::thread worker([]() { TRACE("worker %d", 1); });
+  worker.join();
+
+  static char decoded[32768];
+  trace_close(buffer);
+  trace_read_back(trace_decode_text, path, decoded, sizeof(decoded));
+  LOG_ASSERT(strstr(decoded, "entity 7 rover mode 3 speed 1.50"), failedMsg);
+  LOG_ASSERT(strstr(decoded, "big -5 1099511627776 ff"), failedMsg);
+  LOG_ASSERT(strstr(decoded, "a string far longer") && !strstr(decoded, "payload\n"), failedMsg);
+  LOG_ASSERT(strstr(decoded, "worker 1"), failedMsg);
+  LOG_ASSERT(strstr(decoded, "utils_test.cpp:"), failedMsg);
+  LOG_ASSERT(strstr(decoded, "entity") < strstr(decoded, "big"), failedMsg);
+
+  // Once the ring wraps only the newest records remain, oldest first
+  buffer = trace_open(path, 64);
+  for (uint32_t i = 0; i < 100; i++) {
+    TRACE("tick %u", i);
+  }
+  trace_close(buffer);
+  TRACE("not recorded %d", 1); // No active buffer
+  trace_read_back(trace_decode_text, path, decoded, sizeof(decoded));
+  LOG_ASSERT(!strstr(decoded, "tick 35\n"), failedMsg);
+  LOG_ASSERT(strstr(decoded, "tick 36\n") && strstr(decoded, "tick 99\n"), failedMsg);
+  LOG_ASSERT(strstr(decoded, "tick 36\n") < strstr(decoded, "tick 99\n"), failedMsg);
+
+  trace_read_back(trace_decode_chrome, path, decoded, sizeof(decoded));
+  LOG_ASSERT(strncmp(decoded, "{\"traceEvents\":[", 16) == 0, failedMsg);
+  LOG_ASSERT(strstr(decoded, "{\"name\":\"tick 99\",\"ph\":\"i\""), failedMsg);
+  remove_file(path);
+
+  LOG_TRACE("[ PASSED ] trace_test");
+}
+
+static uint32_t count_occurrences(const char* text, const char* pattern) {
+  uint32_t count = 0;
+  for (const char* found = strstr(text, pattern); found; found = strstr(found + 1, pattern)) count++;
+  return count;
+}
+
+void profile_test() {
+  const char* failedMsg = "[ FAILED ] profile_test";
+  const char* path = "profile_test.json";
+  Arena arena(MB(4));
+
+  Profiler* profiler = profiler_create(arena, 60); // Rounds up to 64 events per thread
+  LOG_ASSERT(profiler && profilerActive == profiler && profiler->eventsPerThread == 64, failedMsg);
+
+  PROFILE_FRAME();
+  {
+    PROFILE_SCOPE("outer");
+    {
+      PROFILE_SCOPE("inner");
+      LOG_ASSERT(profileThread && profileThread->depth == 2, failedMsg);
+    }
+    PROFILE_COUNTER("entities", 42);
+  }
+  LOG_ASSERT(profileThread->depth == 0 && profileThread->writePos.load() == 4, failedMsg);
+  std::thread worker([]() { PROFILE_SCOPE("worker"); });
+  worker.join();
+  LOG_ASSERT(profiler->threadCount == 2 && profiler->nameCount == 4, failedMsg);
+
+  // A reloaded library starts with fresh sites & thread locals, it gets the same name ids & ring back
+  ProfileThread* ring = profileThread;
+  ProfileSite reloaded("outer");
+  ProfileSite other("outer");
+  LOG_ASSERT(profile_name(*profiler, reloaded) == profile_name(*profiler, other) && profiler->nameCount == 4, failedMsg);
+  profileThreadSerial = 0;
+  LOG_ASSERT(profile_thread() == ring && profiler->threadCount == 2, failedMsg);
+
+  Arena readArena(MB(1));
+  LOG_ASSERT(profiler_write_chrome(*profiler, path), failedMsg);
+  const char* json = read_file(path, readArena);
+  LOG_ASSERT(strncmp(json, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", 39) == 0, failedMsg);
+  LOG_ASSERT(strstr(json, "{\"name\":\"outer\",\"ph\":\"X\""), failedMsg);
+  LOG_ASSERT(strstr(json, "{\"name\":\"inner\",\"ph\":\"X\""), failedMsg);
+  LOG_ASSERT(strstr(json, "\"depth\":1}"), failedMsg);
+  LOG_ASSERT(strstr(json, "\"inner\"") < strstr(json, "\"outer\""), failedMsg); // Zones are recorded on close
+  LOG_ASSERT(strstr(json, "{\"name\":\"entities\",\"ph\":\"C\"") && strstr(json, "\"value\":42}"), failedMsg);
+  LOG_ASSERT(strstr(json, "{\"name\":\"frame\",\"ph\":\"i\"") && strstr(json, "\"frame\":1}"), failedMsg);
+  LOG_ASSERT(strstr(json, "{\"name\":\"worker\",\"ph\":\"X\""), failedMsg);
+
+  // Once a ring wraps only the newest events remain
+  for (uint32_t i = 0; i < 100; i++) {
+    PROFILE_SCOPE("tick");
+  }
+  LOG_ASSERT(profiler_write_chrome(*profiler, path), failedMsg);
+  json = read_file(path, readArena);
+  LOG_ASSERT(count_occurrences(json, "\"name\":\"tick\"") == 64 && !strstr(json, "\"outer\""), failedMsg);
+  LOG_ASSERT(strstr(json, "\"worker\""), failedMsg);
+
+  profiler_attach(nullptr);
+  {
+    PROFILE_SCOPE("not recorded");
+  }
+  LOG_ASSERT(ring->writePos.load() == 104, failedMsg);
+  remove_file(path);
+
+  LOG_TRACE("[ PASSED ] profile_test");
+}
+
+void benchmark_test() {
+  const char* failedMsg = "[ FAILED ] benchmark_test";
+
+  double samples[] = {9.0, 1.0, 5.0, 3.0, 7.0, 2.0, 8.0, 4.0, 6.0, 10.0};
+  BenchmarkResult stats = {};
+  benchmark_stats(samples, 10, stats);
+  LOG_ASSERT(stats.samples == 10 && stats.minNs == 1.0 && stats.p99Ns == 10.0, failedMsg);
+  LOG_ASSERT(stats.medianNs == 5.5 && stats.meanNs == 5.5, failedMsg);
+  LOG_ASSERT(CompareFloat((float)stats.stddevNs, 3.02765f), failedMsg);
+
+  BenchmarkSuite suite(8);
+  suite.config.warmupMs = 1.0;
+  suite.config.minSampleUs = 20.0;
+  suite.config.samples = 5;
+
+  uint64_t total = 0;
+  const BenchmarkResult* result = suite.run("sum", [&]() {
+    for (uint32_t i = 0; i < 64; i++) total += i;
+    do_not_optimize(total);
+  });
+  LOG_ASSERT(result && result->samples == 5 && result->iterations > 1, failedMsg);
+  LOG_ASSERT(result->minNs > 0.0 && result->minNs <= result->medianNs && result->medianNs <= result->p99Ns, failedMsg);
+
+  uint32_t setups = 0;
+  uint32_t calls = 0;
+  result = suite.run_with_setup("setup", 3, [&](uint64_t param) { setups += (uint32_t)param; }, [&](uint64_t) { calls++; });
+  LOG_ASSERT(result && result->iterations == 1 && result->param == 3 && setups == calls * 3, failedMsg);
+
+  const uint64_t sizes[] = {16, 256};
+  suite.run_params("sizes", sizes, 2, [&](uint64_t size) {
+    for (uint64_t i = 0; i < size; i++) total += i;
+    do_not_optimize(total);
+  });
+
+  // Counters are optional, without a PMU or permission results stay time only
+  bool counters = suite.enable_counters();
+  result = suite.run("counted", [&]() { do_not_optimize(++total); });
+  LOG_ASSERT(result->counterMask == (counters ? suite.perf.mask : 0u), failedMsg);
+  LOG_ASSERT(!(result->counterMask & (1u << PERF_INSTRUCTIONS)) || result->counters[PERF_INSTRUCTIONS] > 0.0, failedMsg);
+
+  suite.filter = "nothing";
+  LOG_ASSERT(!suite.run("skipped", []() {}), failedMsg);
+  LOG_ASSERT(suite.results.count == 5 && suite.results[3].param == 256, failedMsg);
+
+  // Compared against itself nothing regresses, once everything takes twice as long it all does
+  const char* path = "benchmark_test.csv";
+  LOG_ASSERT(suite.write_csv(path), failedMsg);
+  LOG_ASSERT(suite.compare_baseline(path, 0.1) == 0, failedMsg);
+  for (uint32_t i = 0; i < suite.results.count; i++) {
+    suite.results[i].medianNs *= 2.0;
+  }
+  LOG_ASSERT(suite.compare_baseline(path, 0.1) == 5, failedMsg);
+  remove_file(path);
+
+  LOG_TRACE("[ PASSED ] benchmark_test");
+}
+
 void create_arena_clear_test() {
   Arena& arena = *new Arena(KB(1));
   const char* failedMsg = "[ FAILED ] create_arena_clear_test";
@@ -647,7 +1738,7 @@ void file_io_test() {
   LOG_ASSERT(file_exists(filePath), failedMsg);
 
   const char* filePathCopy = "./create_and_remove_file_test_copy";
-  copy_file(filePath, filePathCopy, arena);
+  LOG_ASSERT(copy_file(filePath, filePathCopy), failedMsg);
   LOG_ASSERT(file_exists(filePathCopy), failedMsg);
 
   LOG_ASSERT(get_file_size(filePath) == strlen(contents), failedMsg);
@@ -671,3 +1762,120 @@ void file_io_test() {
   delete &arena;
   LOG_TRACE("[ PASSED ] create_and_remove_file_test");
 }
+
+void file_view_test() {
+  const char* failedMsg = "[ FAILED ] file_view_test";
+  const char* filePath = "./file_view_test";
+
+  // Bigger than a page so the view spans several
+  static char contents[10000];
+  for (uint32_t i = 0; i < sizeof(contents); i++) contents[i] = (char)('a' + i % 26);
+  write_file(filePath, contents, sizeof(contents));
+
+  FileView view;
+  LOG_ASSERT(map_file(filePath, view, FileAdvice::Sequential), failedMsg);
+  LOG_ASSERT(view.size == sizeof(contents) && view.size == get_file_size(filePath), failedMsg);
+  LOG_ASSERT(memcmp(view.data, contents, sizeof(contents)) == 0, failedMsg);
+  advise_file(view, FileAdvice::Random);
+  advise_file(view, FileAdvice::WillNeed);
+  LOG_ASSERT(view.data[9999] == contents[9999], failedMsg);
+  unmap_file(view);
+  LOG_ASSERT(!view.data && !view.size, failedMsg);
+
+  {
+    FileViewScope scope(filePath);
+    LOG_ASSERT(scope.mapped && memcmp(scope.view.data, contents, sizeof(contents)) == 0, failedMsg);
+  }
+
+  // Empty files map to an empty view, missing files fail cleanly
+  write_file(filePath, contents, 0);
+  LOG_ASSERT(map_file(filePath, view) && view.size == 0 && view.data, failedMsg);
+  unmap_file(view);
+  remove_file(filePath);
+  LOG_ASSERT(!map_file(filePath, view) && !view.data && !view.size, failedMsg);
+  unmap_file(view);
+
+  LOG_TRACE("[ PASSED ] file_view_test");
+}
+
+static void async_io_count(IoRequest& request) {
+  (*(uint32_t*)request.user)++;
+}
+
+static void async_io_backend_test(IoBackend preferred, const char* failedMsg) {
+  const char* filePath = "./async_io_test";
+  static char contents[100000];
+  for (uint32_t i = 0; i < sizeof(contents); i++) contents[i] = (char)('a' + i % 26);
+  write_file(filePath, contents, sizeof(contents));
+
+  AsyncIo* io = async_io_create(4, 2, preferred); // Less depth than requests, submit has to wait for room
+  LOG_ASSERT(io, failedMsg);
+  if (preferred == IoBackend::Workers) LOG_ASSERT(async_io_backend(*io) == IoBackend::Workers, failedMsg);
+
+  Arena arena(MB(1));
+  const uint32_t chunkCount = 10;
+  const uint64_t chunkSize = sizeof(contents) / chunkCount;
+  IoRequest* requests = new IoRequest[chunkCount + 2];
+  uint32_t callbacks = 0;
+  for (uint32_t i = 0; i < chunkCount; i++) {
+    requests[i].path = filePath;
+    requests[i].offset = i * chunkSize;
+    requests[i].size = chunkSize;
+    requests[i].buffer = arena.alloc_raw<char>(chunkSize);
+    requests[i].callback = async_io_count;
+    requests[i].user = &callbacks;
+  }
+  requests[chunkCount].path = filePath; // Runs past the end of the file
+  requests[chunkCount].offset = sizeof(contents) - 100;
+  requests[chunkCount].size = 1000;
+  requests[chunkCount].buffer = arena.alloc_raw<char>(1000);
+  requests[chunkCount + 1].path = "./async_io_test_missing";
+  requests[chunkCount + 1].size = 16;
+  requests[chunkCount + 1].buffer = arena.alloc_raw<char>(16);
+
+  async_io_submit(*io, requests, chunkCount + 2);
+  async_io_wait(*io, requests[chunkCount + 1]);
+  LOG_ASSERT(requests[chunkCount + 1].status == IoStatus::Failed && requests[chunkCount + 1].result < 0, failedMsg);
+  async_io_wait_all(*io);
+  LOG_ASSERT(callbacks == chunkCount, failedMsg);
+  for (uint32_t i = 0; i < chunkCount; i++) {
+    LOG_ASSERT(requests[i].status == IoStatus::Done && requests[i].result == (int64_t)chunkSize, failedMsg);
+    LOG_ASSERT(memcmp(requests[i].buffer, contents + i * chunkSize, chunkSize) == 0, failedMsg);
+  }
+  LOG_ASSERT(requests[chunkCount].status == IoStatus::Done && requests[chunkCount].result == 100, failedMsg);
+  LOG_ASSERT(memcmp(requests[chunkCount].buffer, contents + sizeof(contents) - 100, 100) == 0, failedMsg);
+
+  // Write through a path, read back through an fd the caller owns
+  IoRequest write;
+  write.op = IoOp::Write;
+  write.path = filePath;
+  write.offset = 10;
+  write.size = 5;
+  write.buffer = (char*)"HELLO";
+  async_io_submit(*io, &write, 1);
+  async_io_wait(*io, write);
+  LOG_ASSERT(write.status == IoStatus::Done && write.result == 5, failedMsg);
+
+  FILE* file = fopen(filePath, "rb");
+  IoRequest read;
+  read.fd = fileno(file);
+  read.offset = 8;
+  read.size = 9;
+  read.buffer = arena.alloc_raw<char>(10);
+  async_io_submit(*io, &read, 1);
+  async_io_wait(*io, read);
+  fclose(file);
+  read.buffer[9] = 0;
+  LOG_ASSERT(read.status == IoStatus::Done && strcmp(read.buffer, "ijHELLOpq") == 0, failedMsg);
+
+  delete[] requests;
+  async_io_destroy(io);
+  remove_file(filePath);
+}
+
+void async_io_test() {
+  const char* failedMsg = "[ FAILED ] async_io_test";
+  async_io_backend_test(IoBackend::Uring, failedMsg); // Falls back to workers without io_uring
+  async_io_backend_test(IoBackend::Workers, failedMsg);
+  LOG_TRACE("[ PASSED ] async_io_test");
+}
@@ -39,12 +39,35 @@ void iterators_arrays_CT_test();
 void iterators_arrays_RT_test();
 void create_and_fetch_arena_in_different_scope_CT_test();
 void create_and_fetch_arena_in_different_scope_RT_test();
+void arena_index_test();
 void create_hashmap_in_arena_CT_test();
 void create_hashmap_in_arena_RT_test();
+void hashmap_churn_test();
+void growable_hashmap_test();
+void hashing_test();
+void key_compare_test();
 void quicksort_test();
+void sort_test();
+void radix_sort_test();
+void soa_test();
 void gen_sparse_set_ct_test();
 void gen_sparse_set_rt_test();
+void paged_gen_sparse_set_test();
+void component_view_test();
 void create_arena_clear_test();
+void arena_virtual_memory_test();
+void arena_temp_test();
+void arena_alignment_test();
+void pool_test();
+void arena_stats_test();
+void ring_buffer_test();
+void bitset_test();
+void log_test();
+void trace_test();
+void profile_test();
+void benchmark_test();
 
 // NOTE: File I/O
 void file_io_test();
+void file_view_test();
+void async_io_test();
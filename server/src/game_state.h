@@ -5,6 +5,9 @@
 struct GameState {
     Camera2D camera;
     entt::registry registry;
+    Arena profilerArena{MB(64)}; // Profiler & its per thread rings, never clears
+    Profiler* profiler = profiler_create(profilerArena); // Created by the host, the library attaches on every load
+    TraceBuffer* trace = nullptr; // Opened by the host, the library attaches on every load
 };
 
 // Components
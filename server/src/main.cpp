@@ -43,7 +43,9 @@ int main() {
         return 1;
     }
 
+    TraceScope tracing("server.trace"); // Outlives reloads, so the records leading up to one survive it
     GameState state = {};
+    state.trace = tracing.buffer;
 
     while(1) {
         server.main(&state);
@@ -44,6 +44,7 @@ void ServerCallbacks::OnNetConnectionStatusChanged(SteamNetConnectionStatusChang
     const SteamNetConnectionInfo_t& info = pCallback->m_info;
     ESteamNetworkingConnectionState eOldState = pCallback->m_eOldState;
 
+    TRACE("connection %u state %d -> %d", hConn, eOldState, info.m_eState);
     LOG_TRACE("Connection state changed - Old: %d, New: %d", eOldState, info.m_eState);
 
     // Handle new connection attempts
@@ -119,6 +120,9 @@ void ServerCallbacks::OnValidateAuthTicketResponse(ValidateAuthTicketResponse_t*
 }
 
 extern "C" void server_main(GameState* state) {
+    LogScope logging; // Joined before returning, so nothing keeps running once the library is unloaded
+    trace_attach(state->trace);
+    profiler_attach(state->profiler);
     LOG_TRACE("Initializing Steam Game Server...");
     
     if (!SteamGameServer_Init(
@@ -256,7 +260,11 @@ extern "C" void server_main(GameState* state) {
 
     time_t last_write_time = get_timestamp("./libserver.so");
     while(last_write_time == get_timestamp("./libserver.so")) {
-        SteamGameServer_RunCallbacks();
+        PROFILE_FRAME();
+        {
+            PROFILE_SCOPE("run callbacks");
+            SteamGameServer_RunCallbacks();
+        }
 
         static time_t next_check = 0;
         time_t now = time(nullptr);
@@ -279,7 +287,9 @@ extern "C" void server_main(GameState* state) {
         }
 
         // Just handle messages from existing connections
+        PROFILE_COUNTER("connections", g_activeConnections.size());
         for (const auto& conn : g_activeConnections) {
+            PROFILE_SCOPE("receive messages");
             ISteamNetworkingMessage* pIncomingMsg[32];
             int numMsgs = g_pNetworkingSockets->ReceiveMessagesOnConnection(conn, pIncomingMsg, 32);
             
@@ -297,6 +307,7 @@ extern "C" void server_main(GameState* state) {
     }
 
     LOG_TRACE("Server shutting down...");
+    profiler_write_chrome(*state->profiler, "server_profile.json");
     
     for (const auto& conn : g_activeConnections) {
         g_pNetworkingSockets->CloseConnection(conn, 0, "Server shutting down", false);